@@ -0,0 +1,168 @@
+#include "geometry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+//every allocation of the process goes through here, so allocations per operation can be counted
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+	allocations++;
+	void* memory = malloc(size ? size : 1);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+const double MIN_BENCHMARK_TIME = 0.2; //seconds each case runs at least
+static volatile size_t sink; //keeps the results alive, so the work is not optimized away
+
+//runs build until MIN_BENCHMARK_TIME has passed and prints one row of the report
+template <typename Build>
+void benchmark(const char* name, const char* parameters, Build build)
+{
+	size_t vertices = 0;
+	{
+		MeshData mesh;
+		build(OUT mesh); //warm up and count the vertices of one operation
+		vertices = mesh.vertices.size() / 3;
+	}
+
+	long long operations = 0;
+	size_t allocationsBefore = allocations;
+	auto start = std::chrono::steady_clock::now();
+	double seconds = 0.0;
+	for (long long batch = 1; seconds < MIN_BENCHMARK_TIME; batch *= 2)
+	{
+		for (long long i = 0; i < batch; i++)
+		{
+			MeshData mesh;
+			build(OUT mesh);
+			sink = mesh.indices.size();
+		}
+		operations += batch;
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	size_t allocated = allocations - allocationsBefore;
+
+	printf("%-16s %-32s %12.1f %10zu %14.3e %10.2f\n", name, parameters, seconds * 1e9 / operations,
+		vertices, vertices * operations / seconds, (double)allocated / operations);
+}
+
+//what drawTable builds when it has nothing cached: the plot, one leg (drawn instanced) and the leg centers.
+//drawTable itself needs a GL context, its upload and draw calls are left to the frame timers
+static void buildTable(OUT MeshData& mesh, Shape plotShape, Shape legShape, float maxError)
+{
+	const float plotWidth = 120.0f, plotLength = 80.0f, plotHeight = 3.0f, legHeight = 70.0f;
+	const float legSize = 5.0f;
+	if (plotShape == RECTANGLE)
+		buildParallelepiped(OUT mesh, plotWidth, plotLength, plotHeight);
+	else
+		buildOvalPlot(OUT mesh, plotWidth, plotLength, plotHeight, Point(0, 0, 0), maxError);
+	MeshData leg;
+	if (legShape == CIRCLE)
+		buildCylinder(OUT leg, legSize, legHeight, Point(0, 0, 0), maxError);
+	else if (legShape == RECTANGLE)
+		buildParallelepiped(OUT leg, legSize, 2 * legSize, legHeight);
+	else
+		buildParallelepiped(OUT leg, legSize, legSize, legHeight);
+	appendGeometry(OUT mesh, leg.vertices.data(), leg.vertices.size(), leg.indices.data(), leg.indices.size());
+	sink = legCenters(plotShape, plotWidth, plotLength, plotHeight, legShape == RECTANGLE ? legSize : legSize / 2, legHeight).size();
+}
+
+int main()
+{
+	char parameters[64];
+	printf("%-16s %-32s %12s %10s %14s %10s\n", "function", "parameters", "ns/op", "vertices", "vertices/s", "allocs/op");
+
+	const float sizes[] = { 10.0f, 100.0f, 1000.0f };
+	for (float size : sizes)
+	{
+		snprintf(parameters, sizeof(parameters), "size=%g", size);
+		benchmark("parallelepiped", parameters, [size](OUT MeshData& mesh) { buildParallelepiped(OUT mesh, size, size, size); });
+	}
+
+	const int segmentCounts[] = { MIN_CIRCLE_SEGMENTS, 25, 50, MAX_CIRCLE_SEGMENTS };
+	const float drawAngles[] = { pi / 2, 2 * pi };
+	for (float drawAngle : drawAngles)
+	{
+		for (int segments : segmentCounts)
+		{
+			snprintf(parameters, sizeof(parameters), "angle=%.2f segments=%d", drawAngle, segments);
+			benchmark("partialCircle", parameters, [drawAngle, segments](OUT MeshData& mesh)
+			{
+				buildPartialCircle(OUT mesh, 50.0f, Point(0, 0, 0), drawAngle, 0.0f, segments);
+			});
+		}
+	}
+
+	//maxError 0 is full detail, the others are what adaptive tessellation asks for at growing distances
+	const float maxErrors[] = { 0.0f, 0.01f, 0.1f, 1.0f };
+	const float ovals[][2] = { { 60.0f, 50.0f }, { 120.0f, 100.0f }, { 250.0f, 200.0f } };
+	for (auto& oval : ovals)
+	{
+		for (float maxError : maxErrors)
+		{
+			float width = oval[0], length = oval[1];
+			snprintf(parameters, sizeof(parameters), "%gx%g maxError=%g", width, length, maxError);
+			benchmark("oval", parameters, [=](OUT MeshData& mesh) { buildOval(OUT mesh, width, length, Point(0, 0, 0), maxError); });
+			benchmark("ovalPlot", parameters, [=](OUT MeshData& mesh) { buildOvalPlot(OUT mesh, width, length, 3.0f, Point(0, 0, 0), maxError); });
+		}
+	}
+
+	const float radii[] = { 2.0f, 5.0f, 10.0f };
+	for (float radius : radii)
+	{
+		for (float maxError : maxErrors)
+		{
+			snprintf(parameters, sizeof(parameters), "r=%g maxError=%g", radius, maxError);
+			benchmark("cylinder", parameters, [=](OUT MeshData& mesh) { buildCylinder(OUT mesh, radius, 70.0f, Point(0, 0, 0), maxError); });
+		}
+	}
+
+	const Shape plotShapes[] = { RECTANGLE, OVAL };
+	const Shape legShapes[] = { SQUARE, RECTANGLE, CIRCLE };
+	for (Shape plotShape : plotShapes)
+	{
+		for (Shape legShape : legShapes)
+		{
+			for (float maxError : maxErrors)
+			{
+				snprintf(parameters, sizeof(parameters), "%s/%s maxError=%g", plotShape == RECTANGLE ? "rectangle" : "oval",
+					legShape == SQUARE ? "square" : legShape == RECTANGLE ? "rectangle" : "circle", maxError);
+				benchmark("table", parameters, [=](OUT MeshData& mesh) { buildTable(OUT mesh, plotShape, legShape, maxError); });
+				benchmark("optimizedTable", parameters, [=](OUT MeshData& mesh) { buildTable(OUT mesh, plotShape, legShape, maxError); optimizeMesh(OUT mesh); });
+			}
+		}
+	}
+
+	//vertex shader runs per triangle before and after optimizeMesh, with a FIFO cache of VERTEX_CACHE_SIZE
+	printf("\n%-16s %-32s %10s %10s %10s %10s\n", "mesh", "parameters", "vertices", "welded", "ACMR", "optimized");
+	for (Shape plotShape : plotShapes)
+	{
+		for (Shape legShape : legShapes)
+		{
+			for (float maxError : maxErrors)
+			{
+				snprintf(parameters, sizeof(parameters), "%s/%s maxError=%g", plotShape == RECTANGLE ? "rectangle" : "oval",
+					legShape == SQUARE ? "square" : legShape == RECTANGLE ? "rectangle" : "circle", maxError);
+				MeshData mesh;
+				buildTable(OUT mesh, plotShape, legShape, maxError);
+				size_t vertices = mesh.vertices.size() / 3;
+				float missRatio = vertexCacheMissRatio(mesh);
+				optimizeMesh(OUT mesh);
+				printf("%-16s %-32s %10zu %10zu %10.3f %10.3f\n", "table", parameters, vertices, mesh.vertices.size() / 3,
+					missRatio, vertexCacheMissRatio(mesh));
+			}
+		}
+	}
+	return 0;
+}
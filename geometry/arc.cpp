@@ -0,0 +1,192 @@
+#include "geometry.h"
+
+//every point is computed from its own angle with a vectorized sincos, so there is no dependency
+//between points (and no drift) like in a rotation recurrence
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ARC_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#include <cpuid.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+//Cephes sinf/cosf constants, the argument is reduced to [-pi/4, pi/4] in three steps
+const float FOPI = 1.27323954473516f; //4 / pi
+const float DP1 = -0.78515625f;
+const float DP2 = -2.4187564849853515625e-4f;
+const float DP3 = -3.77489497744594108e-8f;
+const float SINCOF_P0 = -1.9515295891e-4f;
+const float SINCOF_P1 = 8.3321608736e-3f;
+const float SINCOF_P2 = -1.6666654611e-1f;
+const float COSCOF_P0 = 2.443315711809948e-5f;
+const float COSCOF_P1 = -1.388731625493765e-3f;
+const float COSCOF_P2 = 4.166664568298827e-2f;
+
+static void generateArcScalar(OUT float* vertices, int first, int count, float r, Point center, float startAngle, float step)
+{
+	for (int i = first; i < count; i++)
+	{
+		float angle = startAngle + i * step;
+		vertices[i * 3] = center.x + r * cos(angle);
+		vertices[i * 3 + 1] = center.y + r * sin(angle);
+		vertices[i * 3 + 2] = center.z;
+	}
+}
+
+#ifdef ARC_X86
+static void sincos4(__m128 x, OUT __m128& s, OUT __m128& c)
+{
+	const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+	__m128 signSin = _mm_and_ps(x, signMask);
+	x = _mm_andnot_ps(signMask, x); //|x|
+
+	//octant of the angle, rounded up to an even number
+	__m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOPI)));
+	j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+	__m128 y = _mm_cvtepi32_ps(j);
+
+	__m128 swapSignSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+	__m128 swapSignCos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+	__m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+	signSin = _mm_xor_ps(signSin, swapSignSin);
+
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+	__m128 z = _mm_mul_ps(x, x);
+
+	__m128 polyCos = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COSCOF_P0), z), _mm_set1_ps(COSCOF_P1));
+	polyCos = _mm_add_ps(_mm_mul_ps(polyCos, z), _mm_set1_ps(COSCOF_P2));
+	polyCos = _mm_mul_ps(_mm_mul_ps(polyCos, z), z);
+	polyCos = _mm_sub_ps(polyCos, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+	polyCos = _mm_add_ps(polyCos, _mm_set1_ps(1.0f));
+
+	__m128 polySin = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SINCOF_P0), z), _mm_set1_ps(SINCOF_P1));
+	polySin = _mm_add_ps(_mm_mul_ps(polySin, z), _mm_set1_ps(SINCOF_P2));
+	polySin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(polySin, z), x), x);
+
+	//in odd quadrants sine and cosine swap polynomials
+	s = _mm_or_ps(_mm_and_ps(polyMask, polySin), _mm_andnot_ps(polyMask, polyCos));
+	c = _mm_or_ps(_mm_and_ps(polyMask, polyCos), _mm_andnot_ps(polyMask, polySin));
+	s = _mm_xor_ps(s, signSin);
+	c = _mm_xor_ps(c, swapSignCos);
+}
+
+static int generateArcSSE(OUT float* vertices, int count, float r, Point center, float startAngle, float step)
+{
+	const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	float xs[4], ys[4];
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 angle = _mm_add_ps(_mm_set1_ps(startAngle), _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)i), lane), _mm_set1_ps(step)));
+		__m128 s, c;
+		sincos4(angle, OUT s, OUT c);
+		_mm_storeu_ps(xs, _mm_add_ps(_mm_set1_ps(center.x), _mm_mul_ps(_mm_set1_ps(r), c)));
+		_mm_storeu_ps(ys, _mm_add_ps(_mm_set1_ps(center.y), _mm_mul_ps(_mm_set1_ps(r), s)));
+		for (int k = 0; k < 4; k++)
+		{
+			vertices[(i + k) * 3] = xs[k];
+			vertices[(i + k) * 3 + 1] = ys[k];
+			vertices[(i + k) * 3 + 2] = center.z;
+		}
+	}
+	return i;
+}
+
+TARGET_AVX2 static void sincos8(__m256 x, OUT __m256& s, OUT __m256& c)
+{
+	const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+	__m256 signSin = _mm256_and_ps(x, signMask);
+	x = _mm256_andnot_ps(signMask, x); //|x|
+
+	//octant of the angle, rounded up to an even number
+	__m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOPI)));
+	j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+	__m256 y = _mm256_cvtepi32_ps(j);
+
+	__m256 swapSignSin = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29));
+	__m256 swapSignCos = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+	__m256 polyMask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+	signSin = _mm256_xor_ps(signSin, swapSignSin);
+
+	x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP1)));
+	x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP2)));
+	x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP3)));
+	__m256 z = _mm256_mul_ps(x, x);
+
+	__m256 polyCos = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(COSCOF_P0), z), _mm256_set1_ps(COSCOF_P1));
+	polyCos = _mm256_add_ps(_mm256_mul_ps(polyCos, z), _mm256_set1_ps(COSCOF_P2));
+	polyCos = _mm256_mul_ps(_mm256_mul_ps(polyCos, z), z);
+	polyCos = _mm256_sub_ps(polyCos, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+	polyCos = _mm256_add_ps(polyCos, _mm256_set1_ps(1.0f));
+
+	__m256 polySin = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(SINCOF_P0), z), _mm256_set1_ps(SINCOF_P1));
+	polySin = _mm256_add_ps(_mm256_mul_ps(polySin, z), _mm256_set1_ps(SINCOF_P2));
+	polySin = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(polySin, z), x), x);
+
+	//in odd quadrants sine and cosine swap polynomials
+	s = _mm256_blendv_ps(polyCos, polySin, polyMask);
+	c = _mm256_blendv_ps(polySin, polyCos, polyMask);
+	s = _mm256_xor_ps(s, signSin);
+	c = _mm256_xor_ps(c, swapSignCos);
+}
+
+TARGET_AVX2 static int generateArcAVX2(OUT float* vertices, int count, float r, Point center, float startAngle, float step)
+{
+	const __m256 lane = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+	float xs[8], ys[8];
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 angle = _mm256_add_ps(_mm256_set1_ps(startAngle), _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps((float)i), lane), _mm256_set1_ps(step)));
+		__m256 s, c;
+		sincos8(angle, OUT s, OUT c);
+		_mm256_storeu_ps(xs, _mm256_add_ps(_mm256_set1_ps(center.x), _mm256_mul_ps(_mm256_set1_ps(r), c)));
+		_mm256_storeu_ps(ys, _mm256_add_ps(_mm256_set1_ps(center.y), _mm256_mul_ps(_mm256_set1_ps(r), s)));
+		for (int k = 0; k < 8; k++)
+		{
+			vertices[(i + k) * 3] = xs[k];
+			vertices[(i + k) * 3 + 1] = ys[k];
+			vertices[(i + k) * 3 + 2] = center.z;
+		}
+	}
+	return i;
+}
+
+static bool hasAVX2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuidex(info, 1, 0);
+	bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+	__cpuidex(info, 7, 0);
+	bool avx2 = (info[1] & (1 << 5)) != 0;
+	//the OS has to save the upper halves of the ymm registers
+	return osxsave && avx && avx2 && (_xgetbv(0) & 6) == 6;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+void generateArc(OUT float* vertices, int count, float r, Point center, float startAngle, float step)
+{
+	int done = 0;
+#ifdef ARC_X86
+	static const bool avx2 = hasAVX2();
+	if (avx2)
+		done = generateArcAVX2(OUT vertices, count, r, center, startAngle, step);
+	else
+		done = generateArcSSE(OUT vertices, count, r, center, startAngle, step);
+#endif
+	generateArcScalar(OUT vertices, done, count, r, center, startAngle, step); //the points that don't fill a whole vector
+}
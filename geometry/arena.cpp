@@ -0,0 +1,92 @@
+#include "arena.h"
+
+#include <cstdlib>
+#include <algorithm>
+
+
+Arena::Arena(size_t _blockSize)
+{
+	used = 0;
+	blockSize = _blockSize;
+}
+
+Arena::~Arena()
+{
+	release();
+}
+
+Arena::Arena(Arena&& other) : blocks(std::move(other.blocks)), used(other.used), blockSize(other.blockSize)
+{
+	other.blocks.clear();
+	other.used = 0;
+}
+
+Arena& Arena::operator = (Arena&& other)
+{
+	if (this != &other)
+	{
+		release();
+		blocks = std::move(other.blocks);
+		used = other.used;
+		blockSize = other.blockSize;
+		other.blocks.clear();
+		other.used = 0;
+	}
+	return *this;
+}
+
+void* Arena::allocateBytes(size_t bytes, size_t alignment)
+{
+	if (!blocks.empty())
+	{
+		Block& block = blocks.back();
+		size_t start = (used + alignment - 1) / alignment * alignment;
+		if (start + bytes <= block.size)
+		{
+			used = start + bytes;
+			return block.memory + start;
+		}
+	}
+	//malloc memory is aligned for every type the arena is used with
+	size_t size = std::max(blocks.empty() ? blockSize : blocks.back().size * 2, bytes);
+	Block block;
+	block.memory = (unsigned char*)malloc(size);
+	if (block.memory == nullptr)
+		throw std::bad_alloc();
+	block.size = size;
+	blocks.push_back(block);
+	used = bytes;
+	return block.memory;
+}
+
+void Arena::reset()
+{
+	if (blocks.size() > 1)
+	{
+		//one block as big as all of them, so the same job fits without growing next time
+		size_t size = capacity();
+		release();
+		blockSize = size;
+	}
+	used = 0;
+}
+
+size_t Arena::capacity() const
+{
+	size_t size = 0;
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		size += blocks[i].size;
+	}
+	return size;
+}
+
+void Arena::release()
+{
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		free(blocks[i].memory);
+	}
+	blocks.clear();
+	used = 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+#include <new>
+
+const size_t ARENA_BLOCK_SIZE = 64 * 1024; //bytes of the first block, later blocks are at least twice as big
+
+//contiguous elements owned by someone else, like the memory of an Arena
+template <typename T>
+class Span
+{
+public:
+	Span() : first(nullptr), count(0) {}
+	Span(T* _first, size_t _count) : first(_first), count(_count) {}
+	T* begin() const { return first; }
+	T* end() const { return first + count; }
+	T* data() const { return first; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	T& operator [] (size_t i) const { return first[i]; }
+
+private:
+	T* first;
+	size_t count;
+};
+
+//Bump allocator for the scratch memory of one job. Nothing is freed on its own, reset() drops everything
+//at once and keeps the memory, merged into one block, so a job that runs again allocates nothing.
+class Arena
+{
+public:
+	Arena(size_t blockSize = ARENA_BLOCK_SIZE);
+	~Arena();
+	Arena(Arena&& other);
+	Arena& operator = (Arena&& other);
+	Arena(const Arena&) = delete;
+	Arena& operator = (const Arena&) = delete;
+
+	//count elements, value initialized, only for types that need no destructor
+	template <typename T>
+	Span<T> allocate(size_t count, const T& value = T())
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "the arena never runs destructors");
+		T* memory = (T*)allocateBytes(count * sizeof(T), alignof(T));
+		for (size_t i = 0; i < count; i++)
+		{
+			new (memory + i) T(value);
+		}
+		return Span<T>(memory, count);
+	}
+	void reset();
+	size_t capacity() const; //bytes in all blocks
+
+private:
+	struct Block
+	{
+		unsigned char* memory;
+		size_t size;
+	};
+
+	std::vector<Block> blocks; //the last one is being filled
+	size_t used; //bytes of the last block
+	size_t blockSize;
+
+	void* allocateBytes(size_t bytes, size_t alignment);
+	void release();
+};
@@ -0,0 +1,37 @@
+#include "circletable.h"
+
+template <int Segments>
+constexpr CircleLevel circleLevel()
+{
+	return { Segments, CircleTables<Segments>::table.cosines, CircleTables<Segments>::table.sines,
+		CircleTables<Segments>::table.cap, CircleTables<Segments>::table.cylinder };
+}
+
+//about 25% apart, so snapping up to the next one costs few triangles, the last one is full detail
+static const CircleLevel CIRCLE_LEVELS[] = {
+	circleLevel<MIN_CIRCLE_SEGMENTS>(), circleLevel<8>(), circleLevel<10>(), circleLevel<12>(), circleLevel<16>(),
+	circleLevel<20>(), circleLevel<24>(), circleLevel<32>(), circleLevel<40>(), circleLevel<48>(),
+	circleLevel<64>(), circleLevel<80>(), circleLevel<MAX_CIRCLE_SEGMENTS>()
+};
+const int CIRCLE_LEVEL_COUNT = sizeof(CIRCLE_LEVELS) / sizeof(CIRCLE_LEVELS[0]);
+
+
+const CircleLevel* findCircleLevel(int segments)
+{
+	for (int i = 0; i < CIRCLE_LEVEL_COUNT; i++)
+	{
+		if (CIRCLE_LEVELS[i].segments == segments)
+			return &CIRCLE_LEVELS[i];
+	}
+	return nullptr;
+}
+
+int circleLevelSegments(int segments)
+{
+	for (int i = 0; i < CIRCLE_LEVEL_COUNT; i++)
+	{
+		if (CIRCLE_LEVELS[i].segments >= segments)
+			return CIRCLE_LEVELS[i].segments;
+	}
+	return segments;
+}
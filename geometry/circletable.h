@@ -0,0 +1,110 @@
+#pragma once
+
+#include "geometry.h"
+
+//Points and triangles of full circles for a fixed ladder of segment counts, filled in by the compiler.
+//Full circles are built with the smallest of these counts that keeps the error, so building a cylinder
+//or the round ends of an oval only scales and moves a table instead of evaluating any sine or cosine.
+
+constexpr double EXACT_PI = 3.14159265358979323846;
+const int CIRCLE_SERIES_TERMS = 12; //enough for double precision on [-pi, pi]
+
+constexpr double reduceAngle(double x)
+{
+	while (x > EXACT_PI)
+		x -= 2 * EXACT_PI;
+	while (x < -EXACT_PI)
+		x += 2 * EXACT_PI;
+	return x;
+}
+
+//Taylor series the compiler can evaluate, std::sin and std::cos are not constexpr
+constexpr double constexprSin(double x)
+{
+	x = reduceAngle(x);
+	double term = x, sum = x;
+	for (int n = 1; n < CIRCLE_SERIES_TERMS; n++)
+	{
+		term *= -x * x / ((2 * n) * (2 * n + 1));
+		sum += term;
+	}
+	return sum;
+}
+
+constexpr double constexprCos(double x)
+{
+	x = reduceAngle(x);
+	double term = 1.0, sum = 1.0;
+	for (int n = 1; n < CIRCLE_SERIES_TERMS; n++)
+	{
+		term *= -x * x / ((2 * n - 1) * (2 * n));
+		sum += term;
+	}
+	return sum;
+}
+
+template <int Segments>
+struct CircleTable
+{
+	float cosines[Segments]; //of the same angles generateArc uses for a full circle from angle 0
+	float sines[Segments];
+	unsigned int cap[Segments * 3]; //fan of buildPartialCircle, the center is 0 and point i is i + 1
+	unsigned int cylinder[Segments * 12]; //both caps of buildCylinder and the wall between them, the bottom cap starts at Segments + 1
+};
+
+template <int Segments>
+constexpr CircleTable<Segments> makeCircleTable()
+{
+	CircleTable<Segments> table = {};
+	const float step = 2 * pi / Segments;
+	for (int i = 0; i < Segments; i++)
+	{
+		table.cosines[i] = (float)constexprCos(i * step);
+		table.sines[i] = (float)constexprSin(i * step);
+	}
+
+	//the same triangles, in the same order, as the loops of buildPartialCircle and buildSideWall
+	const unsigned int bottom = Segments + 1;
+	for (unsigned int i = 0; i < Segments; i++)
+	{
+		unsigned int next = (i + 1) % Segments;
+		unsigned int fan[] = { 0, i + 1, next + 1 };
+		unsigned int quad[] = {
+			1 + i, 1 + next, bottom + 1 + i,
+			1 + next, bottom + 1 + i, bottom + 1 + next
+		};
+		for (int k = 0; k < 3; k++)
+		{
+			table.cap[i * 3 + k] = fan[k];
+			table.cylinder[i * 3 + k] = fan[k];
+			table.cylinder[Segments * 3 + i * 3 + k] = bottom + fan[k];
+		}
+		for (int k = 0; k < 6; k++)
+		{
+			table.cylinder[Segments * 6 + i * 6 + k] = quad[k];
+		}
+	}
+	return table;
+}
+
+//one table per instantiation, stored in the binary
+template <int Segments>
+struct CircleTables
+{
+	static constexpr CircleTable<Segments> table = makeCircleTable<Segments>();
+};
+template <int Segments>
+constexpr CircleTable<Segments> CircleTables<Segments>::table;
+
+//a table of any segment count, for the code that picks one at run time
+struct CircleLevel
+{
+	int segments;
+	const float* cosines;
+	const float* sines;
+	const unsigned int* cap;
+	const unsigned int* cylinder;
+};
+
+const CircleLevel* findCircleLevel(int segments); //null when there is no table for that count
+int circleLevelSegments(int segments); //smallest count with a table that is at least segments
@@ -0,0 +1,286 @@
+#include "geometry.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+
+//the exporters read the vertices and indices of the parts directly and write through one fixed buffer,
+//nothing is copied per instance. Binary output assumes a little endian host, like every target of the project
+const size_t EXPORT_BUFFER_SIZE = 1 << 16;
+
+class FileWriter
+{
+public:
+	FileWriter(const std::string& path) : file(path, std::ios::binary), used(0) {}
+	~FileWriter() { flush(); }
+	bool isOpen() const { return (bool)file; }
+	bool good() { flush(); return (bool)file; }
+
+	void write(const void* data, size_t size)
+	{
+		if (used + size > EXPORT_BUFFER_SIZE)
+			flush();
+		if (size > EXPORT_BUFFER_SIZE)
+		{
+			file.write((const char*)data, size); //big blocks go around the buffer
+			return;
+		}
+		memcpy(buffer + used, data, size);
+		used += size;
+	}
+	template <typename T>
+	void write(T value) { write(&value, sizeof(T)); }
+	//text output, one line is always much shorter than the buffer
+	template <typename... Args>
+	void print(const char* format, Args... args)
+	{
+		if (used + 256 > EXPORT_BUFFER_SIZE)
+			flush();
+		used += snprintf(buffer + used, EXPORT_BUFFER_SIZE - used, format, args...);
+	}
+
+private:
+	std::ofstream file;
+	char buffer[EXPORT_BUFFER_SIZE];
+	size_t used;
+
+	void flush()
+	{
+		file.write(buffer, used);
+		used = 0;
+	}
+};
+
+static size_t triangleCount(const std::vector<PlacedMesh>& parts)
+{
+	size_t count = 0;
+	for (size_t i = 0; i < parts.size(); i++)
+	{
+		count += parts[i].mesh->indices.size() / 3 * parts[i].offsets.size();
+	}
+	return count;
+}
+
+static Point vertexAt(const MeshData& mesh, unsigned int index, Point offset)
+{
+	const float* v = &mesh.vertices[index * 3];
+	return Point(v[0] + offset.x, v[1] + offset.y, v[2] + offset.z);
+}
+
+static bool failed(const std::string& path)
+{
+	std::cout << "Failed to write " << path << std::endl;
+	return false;
+}
+
+bool exportSTL(const std::string& path, const std::vector<PlacedMesh>& parts)
+{
+	size_t triangles = triangleCount(parts);
+	if (triangles > UINT32_MAX)
+	{
+		std::cout << "Too many triangles for " << path << std::endl;
+		return false;
+	}
+	std::unique_ptr<FileWriter> out(new FileWriter(path)); //the buffer is too big for the stack
+	if (!out->isOpen())
+		return failed(path);
+
+	char header[80] = "binary STL, 1 unit = 1 cm";
+	out->write(header, sizeof(header));
+	out->write((uint32_t)triangles);
+	for (size_t p = 0; p < parts.size(); p++)
+	{
+		const MeshData& mesh = *parts[p].mesh;
+		for (size_t o = 0; o < parts[p].offsets.size(); o++)
+		{
+			Point offset = parts[p].offsets[o];
+			for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+			{
+				Point a = vertexAt(mesh, mesh.indices[i], offset);
+				Point b = vertexAt(mesh, mesh.indices[i + 1], offset);
+				Point c = vertexAt(mesh, mesh.indices[i + 2], offset);
+				//facet normal from the winding
+				float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+				float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+				float n[3] = { uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx };
+				float length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				if (length > 0.0f)
+				{
+					n[0] /= length;
+					n[1] /= length;
+					n[2] /= length;
+				}
+				float facet[12] = { n[0], n[1], n[2], a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z };
+				out->write(facet, sizeof(facet));
+				out->write((uint16_t)0); //attribute byte count
+			}
+		}
+	}
+	return out->good() ? true : failed(path);
+}
+
+bool exportOBJ(const std::string& path, const std::vector<PlacedMesh>& parts)
+{
+	std::unique_ptr<FileWriter> out(new FileWriter(path));
+	if (!out->isOpen())
+		return failed(path);
+
+	out->print("# 1 unit = 1 cm\n");
+	unsigned long long base = 1; //OBJ indices start from 1 and count every vertex written so far
+	for (size_t p = 0; p < parts.size(); p++)
+	{
+		const MeshData& mesh = *parts[p].mesh;
+		size_t vertexCount = mesh.vertices.size() / 3;
+		for (size_t o = 0; o < parts[p].offsets.size(); o++)
+		{
+			Point offset = parts[p].offsets[o];
+			out->print("o %s%u\n", parts[p].name.c_str(), (unsigned int)o + 1);
+			for (size_t v = 0; v < vertexCount; v++)
+			{
+				Point vertex = vertexAt(mesh, (unsigned int)v, offset);
+				out->print("v %.6g %.6g %.6g\n", vertex.x, vertex.y, vertex.z);
+			}
+			for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+			{
+				out->print("f %llu %llu %llu\n", base + mesh.indices[i], base + mesh.indices[i + 1], base + mesh.indices[i + 2]);
+			}
+			base += vertexCount;
+		}
+	}
+	return out->good() ? true : failed(path);
+}
+
+bool exportGLB(const std::string& path, const std::vector<PlacedMesh>& parts, bool compact)
+{
+	//compact parts keep 16 bit positions (KHR_mesh_quantization) and indices, the node of
+	//every instance scales and moves them back
+	std::vector<QuantizedMesh> quantized(parts.size());
+	std::vector<bool> quantizedPart(parts.size(), false);
+	bool anyQuantized = false;
+	for (size_t p = 0; p < parts.size() && compact; p++)
+	{
+		quantizedPart[p] = quantizeMesh(*parts[p].mesh, OUT quantized[p]);
+		anyQuantized = anyQuantized || quantizedPart[p];
+	}
+
+	//every part is stored once and placed by one node per offset, under a root node that
+	//turns the z up centimeters of the project into the y up meters of glTF
+	std::ostringstream json;
+	json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"table\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],";
+	if (anyQuantized)
+		json << "\"extensionsUsed\":[\"KHR_mesh_quantization\"],\"extensionsRequired\":[\"KHR_mesh_quantization\"],";
+	std::ostringstream nodes, meshes, accessors, views;
+	nodes.precision(9); //bounds and offsets as exact as the floats
+	accessors.precision(9);
+	nodes << "\"nodes\":[{\"rotation\":[-0.70710678,0,0,0.70710678],\"scale\":[0.01,0.01,0.01],\"children\":[";
+	size_t nodeCount = 0, byteLength = 0;
+	for (size_t p = 0; p < parts.size(); p++)
+	{
+		for (size_t o = 0; o < parts[p].offsets.size(); o++)
+		{
+			nodeCount++;
+			nodes << (nodeCount > 1 ? "," : "") << nodeCount; //node 0 is the root
+		}
+	}
+	nodes << "]}";
+	for (size_t p = 0; p < parts.size(); p++)
+	{
+		const MeshData& mesh = *parts[p].mesh;
+		const QuantizedMesh& q = quantized[p];
+		size_t vertexCount = mesh.vertices.size() / 3;
+		float minimum[3] = { 0, 0, 0 }, maximum[3] = { 0, 0, 0 }; //required for positions, in steps for compact parts
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				float value = quantizedPart[p] ? q.positions[v * 4 + k] : mesh.vertices[v * 3 + k];
+				minimum[k] = v == 0 ? value : std::min(minimum[k], value);
+				maximum[k] = v == 0 ? value : std::max(maximum[k], value);
+			}
+		}
+		for (size_t o = 0; o < parts[p].offsets.size(); o++)
+		{
+			Point offset = parts[p].offsets[o];
+			nodes << ",{\"name\":\"" << parts[p].name << o + 1 << "\",\"mesh\":" << p;
+			if (quantizedPart[p])
+				nodes << ",\"translation\":[" << offset.x + q.offset.x << "," << offset.y + q.offset.y << "," << offset.z + q.offset.z
+					<< "],\"scale\":[" << q.scale.x << "," << q.scale.y << "," << q.scale.z << "]}";
+			else
+				nodes << ",\"translation\":[" << offset.x << "," << offset.y << "," << offset.z << "]}";
+		}
+		//views and accessors 2p and 2p + 1 are the positions and indices of part p
+		size_t positionBytes = quantizedPart[p] ? q.positions.size() * sizeof(unsigned short) : mesh.vertices.size() * sizeof(float);
+		size_t indexBytes = quantizedPart[p] ? q.indices.size() * sizeof(unsigned short) : mesh.indices.size() * sizeof(unsigned int);
+		meshes << (p ? "," : "") << "{\"name\":\"" << parts[p].name << "\",\"primitives\":[{\"attributes\":{\"POSITION\":"
+			<< 2 * p << "},\"indices\":" << 2 * p + 1 << ",\"mode\":4}]}";
+		views << (p ? "," : "") << "{\"buffer\":0,\"byteOffset\":" << byteLength << ",\"byteLength\":" << positionBytes
+			<< (quantizedPart[p] ? ",\"byteStride\":8" : "") << ",\"target\":34962}";
+		byteLength += positionBytes;
+		views << ",{\"buffer\":0,\"byteOffset\":" << byteLength << ",\"byteLength\":" << indexBytes << ",\"target\":34963}";
+		byteLength += (indexBytes + 3) / 4 * 4; //the next positions start 4 byte aligned
+		accessors << (p ? "," : "") << "{\"bufferView\":" << 2 * p << ",\"componentType\":" << (quantizedPart[p] ? 5123 : 5126)
+			<< ",\"count\":" << vertexCount << ",\"type\":\"VEC3\""
+			<< ",\"min\":[" << minimum[0] << "," << minimum[1] << "," << minimum[2] << "],\"max\":[" << maximum[0] << "," << maximum[1] << "," << maximum[2] << "]}"
+			<< ",{\"bufferView\":" << 2 * p + 1 << ",\"componentType\":" << (quantizedPart[p] ? 5123 : 5125)
+			<< ",\"count\":" << mesh.indices.size() << ",\"type\":\"SCALAR\"}";
+	}
+	nodes << "]";
+	json << nodes.str() << ",\"meshes\":[" << meshes.str() << "],\"accessors\":[" << accessors.str() << "],\"bufferViews\":[" << views.str()
+		<< "],\"buffers\":[{\"byteLength\":" << byteLength << "}]}";
+	std::string text = json.str();
+	while (text.size() % 4 != 0)
+	{
+		text += ' '; //chunks are 4 byte aligned, the binary one already is
+	}
+	if (12 + 8 + text.size() + 8 + byteLength > UINT32_MAX)
+	{
+		std::cout << "Too much geometry for " << path << std::endl;
+		return false;
+	}
+
+	std::unique_ptr<FileWriter> out(new FileWriter(path));
+	if (!out->isOpen())
+		return failed(path);
+	out->write((uint32_t)0x46546C67); //"glTF"
+	out->write((uint32_t)2);
+	out->write((uint32_t)(12 + 8 + text.size() + 8 + byteLength));
+	out->write((uint32_t)text.size());
+	out->write((uint32_t)0x4E4F534A); //"JSON"
+	out->write(text.data(), text.size());
+	out->write((uint32_t)byteLength);
+	out->write((uint32_t)0x004E4942); //"BIN"
+	const char padding[4] = { 0, 0, 0, 0 };
+	for (size_t p = 0; p < parts.size(); p++)
+	{
+		const MeshData& mesh = *parts[p].mesh;
+		if (quantizedPart[p])
+		{
+			out->write(quantized[p].positions.data(), quantized[p].positions.size() * sizeof(unsigned short));
+			out->write(quantized[p].indices.data(), quantized[p].indices.size() * sizeof(unsigned short));
+			out->write(padding, quantized[p].indices.size() % 2 * sizeof(unsigned short));
+		}
+		else
+		{
+			out->write(mesh.vertices.data(), mesh.vertices.size() * sizeof(float));
+			out->write(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+		}
+	}
+	return out->good() ? true : failed(path);
+}
+
+bool exportMesh(const std::string& path, const std::vector<PlacedMesh>& parts, bool compact)
+{
+	std::string extension = path.substr(path.find_last_of('.') + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	if (extension == "stl")
+		return exportSTL(path, parts);
+	if (extension == "obj")
+		return exportOBJ(path, parts);
+	if (extension == "glb")
+		return exportGLB(path, parts, compact);
+	std::cout << "Unknown export format of " << path << ", valid options are: stl, obj and glb" << std::endl;
+	return false;
+}
@@ -0,0 +1,309 @@
+#include "geometry.h"
+#include "circletable.h"
+
+
+void appendGeometry(OUT MeshData& mesh, float* vertices, size_t verticesSize, unsigned int* indices, size_t indicesSize)
+{
+	unsigned int first = mesh.vertices.size() / 3; //indices are local to the appended part
+	mesh.vertices.insert(mesh.vertices.end(), vertices, vertices + verticesSize);
+	mesh.indices.reserve(mesh.indices.size() + indicesSize);
+	for (int i = 0; i < indicesSize; i++)
+	{
+		mesh.indices.push_back(first + indices[i]);
+	}
+}
+
+void buildSideWall(OUT MeshData& mesh, unsigned int top, unsigned int bottom, unsigned int count, bool closed)
+{
+	//the wall reuses the outline vertices of both caps, so it only adds indices
+	unsigned int quads = closed ? count : count - 1;
+	mesh.indices.reserve(mesh.indices.size() + quads * 6);
+	for (unsigned int i = 0; i < quads; i++)
+	{
+		unsigned int next = (i + 1) % count;
+		unsigned int quad[] = {
+			top + i, top + next, bottom + i,
+			top + next, bottom + i, bottom + next
+		};
+		mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+	}
+}
+
+Outline buildParallelepiped(OUT MeshData& mesh, float width, float length, float height, Point center)
+{
+	size_t first = mesh.vertices.size() / 3;
+	float x = width / 2, y = length / 2, z = height / 2;
+	float vertices[] = {
+		-x, -y, -z,
+		x, -y, -z,
+		-x, y, -z,
+		x, y, -z,
+		-x, -y, z,
+		x, -y, z,
+		-x, y, z,
+		x, y, z
+	};
+	for (int i = 0; i < 24; i += 3)
+	{
+		vertices[i] += center.x;
+		vertices[i + 1] += center.y;
+		vertices[i + 2] += center.z;
+	}
+	unsigned int indices[] = {
+		0, 1, 2, //predna stena
+		1, 2, 3,
+		4, 5, 6, //zadna stena
+		5, 6, 7,
+		0, 1, 4, //dolna stena
+		1, 4, 5,
+		2, 3, 6, //gorna stena
+		3, 6, 7,
+		0, 2, 4, //lqva stena
+		2, 4, 6,
+		1, 3, 5, //dqsna stena
+		3, 5, 7
+	};
+
+	appendGeometry(OUT mesh, vertices, 24, indices, 36);
+
+	return Outline(mesh, first, 8);
+}
+
+int circleSegments(float radius, float maxError, float drawAngle)
+{
+	if (maxError <= 0.0f || radius <= maxError)
+		return maxError <= 0.0f ? MAX_CIRCLE_SEGMENTS : MIN_CIRCLE_SEGMENTS;
+	//a chord over angle t is at most r*(1 - cos(t/2)) away from the arc
+	float segmentAngle = 2 * acos(1 - maxError / radius);
+	int segments = (int)ceil(fabs(drawAngle) / segmentAngle);
+	return std::min(std::max(segments, MIN_CIRCLE_SEGMENTS), MAX_CIRCLE_SEGMENTS);
+}
+
+int circlePoints(float drawAngle, int segments)
+{
+	//a full circle closes on its first point, an arc needs one more point for its end
+	return fabs(drawAngle) >= 2 * pi ? segments : segments + 1;
+}
+
+void reserveGeometry(OUT MeshData& mesh, size_t vertices, size_t indices)
+{
+	mesh.vertices.reserve(mesh.vertices.size() + vertices * 3);
+	mesh.indices.reserve(mesh.indices.size() + indices);
+}
+
+//center + the points of a full circle, from a table instead of sines and cosines
+static void writeCircle(OUT float* vertices, const CircleLevel& level, float r, Point center)
+{
+	vertices[0] = center.x;
+	vertices[1] = center.y;
+	vertices[2] = center.z;
+	for (int i = 0; i < level.segments; i++)
+	{
+		vertices[(i + 1) * 3] = center.x + r * level.cosines[i];
+		vertices[(i + 1) * 3 + 1] = center.y + r * level.sines[i];
+		vertices[(i + 1) * 3 + 2] = center.z;
+	}
+}
+
+Outline buildPartialCircle(OUT MeshData& mesh, float r, Point center, float drawAngle, float startAngle, int segments)
+{
+	//written straight into the mesh, center + points on the arc
+	size_t first = mesh.vertices.size() / 3;
+	int points = circlePoints(drawAngle, segments);
+	reserveGeometry(OUT mesh, points + 1, segments * 3);
+	mesh.vertices.resize((first + points + 1) * 3);
+	float* vertices = &mesh.vertices[first * 3];
+	const CircleLevel* level = points == segments && startAngle == 0.0f ? findCircleLevel(segments) : nullptr;
+	if (level != nullptr)
+	{
+		writeCircle(OUT vertices, *level, r, center);
+		for (int i = 0; i < segments * 3; i++)
+		{
+			mesh.indices.push_back(first + level->cap[i]);
+		}
+		return Outline(mesh, first, points + 1);
+	}
+	vertices[0] = center.x;
+	vertices[1] = center.y;
+	vertices[2] = center.z;
+	generateArc(OUT vertices + 3, points, r, center, startAngle, drawAngle / segments);
+
+	unsigned int centerIndex = first;
+	for (int j = 1; j < points; j++)
+	{
+		unsigned int triangle[] = { centerIndex, centerIndex + j, centerIndex + j + 1 };
+		mesh.indices.insert(mesh.indices.end(), triangle, triangle + 3);
+	}
+	if (points == segments) //full circle
+	{
+		unsigned int triangle[] = { centerIndex, centerIndex + points, centerIndex + 1 };
+		mesh.indices.insert(mesh.indices.end(), triangle, triangle + 3);
+	}
+
+	return Outline(mesh, first, points + 1);
+}
+
+void ovalArcs(float width, float length, Point center, float maxError, OUT Arc arcs[4])
+{
+	if (width > 1.3*length) 
+		width = 1.3*length;
+	float R = length / 2, r = R / 2, a = width - R - r;
+	arcs[0] = Arc(R, center, 2 * pi, 0.0);
+	arcs[1] = Arc(r, Point(a + center.x, center.y, center.z), 2 * pi, 0.0);
+	//first
+	float firstCenterY = (pow(a, 2) - pow((R - r), 2)) / (2 * (R - r));
+	float firstRadius = (pow(R, 2) - pow(r, 2) + pow(a, 2)) / (2 * (R - r));
+	float firstDrawAngle = atan(a / firstCenterY);
+	float firstStartAngle = atan(firstCenterY / a);
+	arcs[2] = Arc(firstRadius, Point(center.x, -firstCenterY + center.y, center.z), firstDrawAngle, firstStartAngle);
+	//second 
+	float secondCenterY = firstCenterY;
+	float secondRadius = firstRadius;
+	float secondDrawAngle = -firstDrawAngle;
+	float secondStartAngle = -firstStartAngle;
+	arcs[3] = Arc(secondRadius, Point(center.x, secondCenterY + center.y, center.z), secondDrawAngle, secondStartAngle);
+
+	for (int i = 0; i < 4; i++)
+	{
+		arcs[i].segments = circleSegments(arcs[i].radius, maxError, arcs[i].drawAngle);
+	}
+	//the two full circles come from tables
+	arcs[0].segments = circleLevelSegments(arcs[0].segments);
+	arcs[1].segments = circleLevelSegments(arcs[1].segments);
+}
+
+//an oval is two full circles and two arcs, each one a center point followed by its outline points
+static Outline buildOvalArcs(OUT MeshData& mesh, const Arc arcs[4], float z)
+{
+	size_t first = mesh.vertices.size() / 3;
+	for (int i = 0; i < 4; i++)
+	{
+		Point center(arcs[i].center.x, arcs[i].center.y, z);
+		buildPartialCircle(OUT mesh, arcs[i].radius, center, arcs[i].drawAngle, arcs[i].startAngle, arcs[i].segments);
+	}
+	return Outline(mesh, first, mesh.vertices.size() / 3 - first);
+}
+
+static void ovalSize(const Arc arcs[4], OUT size_t& vertices, OUT size_t& indices)
+{
+	vertices = indices = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		vertices += circlePoints(arcs[i].drawAngle, arcs[i].segments) + 1;
+		indices += arcs[i].segments * 3;
+	}
+}
+
+Outline buildOval(OUT MeshData& mesh, float width, float length, Point center, float maxError)
+{
+	Arc arcs[4];
+	ovalArcs(width, length, center, maxError, OUT arcs);
+	size_t vertices, indices;
+	ovalSize(arcs, OUT vertices, OUT indices);
+	reserveGeometry(OUT mesh, vertices, indices);
+	return buildOvalArcs(OUT mesh, arcs, center.z);
+}
+
+Outline buildOvalPlot(OUT MeshData& mesh, float width, float length, float height, Point center, float maxError)
+{
+	Arc arcs[4];
+	ovalArcs(width, length, center, maxError, OUT arcs);
+
+	//both caps and the wall between them in one allocation
+	size_t vertices, indices, wallIndices = 0;
+	ovalSize(arcs, OUT vertices, OUT indices);
+	for (int arc = 0; arc < 4; arc++)
+	{
+		int points = circlePoints(arcs[arc].drawAngle, arcs[arc].segments);
+		wallIndices += (points == arcs[arc].segments ? points : points - 1) * 6;
+	}
+	reserveGeometry(OUT mesh, 2 * vertices, 2 * indices + wallIndices);
+
+	size_t first = mesh.vertices.size() / 3;
+	unsigned int top = first;
+	buildOvalArcs(OUT mesh, arcs, center.z + height / 2);
+	unsigned int bottom = mesh.vertices.size() / 3;
+	buildOvalArcs(OUT mesh, arcs, center.z - height / 2);
+
+	for (int arc = 0, start = 0; arc < 4; arc++)
+	{
+		int points = circlePoints(arcs[arc].drawAngle, arcs[arc].segments);
+		buildSideWall(OUT mesh, top + start + 1, bottom + start + 1, points, points == arcs[arc].segments);
+		start += points + 1;
+	}
+
+	return Outline(mesh, first, mesh.vertices.size() / 3 - first);
+}
+
+Outline buildCylinder(OUT MeshData& mesh, float radius, float height, Point center, float maxError)
+{
+	//both caps and the wall between them are one table, only the points are scaled and moved
+	const CircleLevel& level = *findCircleLevel(circleLevelSegments(circleSegments(radius, maxError)));
+	int segments = level.segments;
+	unsigned int top = mesh.vertices.size() / 3;
+	reserveGeometry(OUT mesh, 2 * (segments + 1), segments * 12);
+	mesh.vertices.resize((top + 2 * (segments + 1)) * 3);
+	writeCircle(OUT &mesh.vertices[top * 3], level, radius, Point(center.x, center.y, center.z + height / 2));
+	writeCircle(OUT &mesh.vertices[(top + segments + 1) * 3], level, radius, Point(center.x, center.y, center.z - height / 2));
+	for (int i = 0; i < segments * 12; i++)
+	{
+		mesh.indices.push_back(top + level.cylinder[i]);
+	}
+
+	return Outline(mesh, top, mesh.vertices.size() / 3 - top);
+}
+
+istream& operator >> (istream& is, Shape& shape)
+{
+	std::string str;
+	is >> str;
+	if (str == "rectangle" || str == "RECTANGLE" || str == "Rectangle" || str == "rect" || str == "Rect" || str == "0")
+		shape = RECTANGLE;
+	if (str == "oval" || str == "OVAL" || str == "Oval" || str == "1")
+		shape = OVAL;
+	if (str == "circle" || str == "CIRCLE" || str == "Circle" || str == "2")
+		shape = CIRCLE;
+	if (str == "triangle" || str == "TRIANGLE" || str == "Triangle" || str == "3")
+		shape = TRIANGLE;
+	if (str == "square" || str == "SQUARE" || str == "Square" || str == "4")
+		shape = SQUARE;
+
+	return is;
+}
+
+ostream& operator << (ostream& os, Shape& shape)
+{
+	switch (shape)
+	{
+	case RECTANGLE: {os << "RECTANGLE"; break; }
+	case OVAL: {os << "OVAL"; break; }
+	case CIRCLE: {os << "CIRCLE"; break; }
+	case TRIANGLE: {os << "TRIANGLE"; break; }
+	case SQUARE: {os << "SQUARE"; break; }
+	}
+
+	return os;
+}
+
+std::vector<Point> legCenters(Shape plotShape, float plotWidth, float plotLength, float plotHeight, float legMaxDist, float legHeight)
+{
+	float offset = 5.0f + legMaxDist; //50 mm offset + offset for center point
+	float legZ = -plotHeight / 2 - legHeight / 2;
+	std::vector<Point> result;
+	result.reserve(4);
+	if (plotShape == RECTANGLE)
+	{
+		result.push_back(Point(plotWidth / 2 - offset, plotLength / 2 - offset, legZ));
+		result.push_back(Point(-plotWidth / 2 + offset, plotLength / 2 - offset, legZ));
+		result.push_back(Point(plotWidth / 2 - offset, -plotLength / 2 + offset, legZ));
+		result.push_back(Point(-plotWidth / 2 + offset, -plotLength / 2 + offset, legZ));
+	}
+	if (plotShape == OVAL)
+	{
+		result.push_back(Point(plotWidth - plotLength / 2 - offset, 0.0, legZ));
+		result.push_back(Point(0.0, plotLength / 2 - offset, legZ));
+		result.push_back(Point(0.0, -plotLength / 2 + offset, legZ));
+	}
+
+	return result;
+}
\ No newline at end of file
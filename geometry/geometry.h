@@ -0,0 +1,139 @@
+#pragma once
+
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <algorithm> //std::max
+
+using std::istream;
+using std::ostream;
+
+#define OUT  //mark out parameters
+
+constexpr float pi = 3.1415f;
+const int MIN_CIRCLE_SEGMENTS = 6;
+const int MAX_CIRCLE_SEGMENTS = 100;
+
+struct Point
+{
+	float x;
+	float y;
+	float z;
+
+	Point() { x = y = z = 0.0; }
+	Point(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+	bool operator == (const Point& other) const { return x == other.x && y == other.y && z == other.z; }
+	bool operator != (const Point& other) const { return !(*this == other); }
+};
+
+//move only, so a mesh is never copied by accident on its way from the builder to the GPU or a file
+struct MeshData
+{
+	std::vector<float> vertices; //x, y, z for every vertex
+	std::vector<unsigned int> indices;
+
+	MeshData() {}
+	MeshData(MeshData&& other) : vertices(std::move(other.vertices)), indices(std::move(other.indices)) {}
+	MeshData& operator = (MeshData&& other) { vertices = std::move(other.vertices); indices = std::move(other.indices); return *this; }
+	MeshData(const MeshData&) = delete;
+	MeshData& operator = (const MeshData&) = delete;
+};
+
+//positions as 16 bit integers over the bounding box of the mesh, vertex v is offset + positions[v] * scale
+struct QuantizedMesh
+{
+	std::vector<unsigned short> positions; //x, y, z and a 0, so every vertex stays 4 byte aligned
+	std::vector<unsigned short> indices;
+	Point offset; //lowest corner of the box
+	Point scale; //size of one step on every axis
+
+	QuantizedMesh() {}
+	QuantizedMesh(QuantizedMesh&& other) : positions(std::move(other.positions)), indices(std::move(other.indices)), offset(other.offset), scale(other.scale) {}
+	QuantizedMesh& operator = (QuantizedMesh&& other) { positions = std::move(other.positions); indices = std::move(other.indices); offset = other.offset; scale = other.scale; return *this; }
+	QuantizedMesh(const QuantizedMesh&) = delete;
+	QuantizedMesh& operator = (const QuantizedMesh&) = delete;
+};
+
+//the points a builder appended to a mesh, read from the mesh itself so nothing is copied.
+//It stays valid while the mesh grows, but not after the mesh is cleared or optimized.
+class Outline
+{
+public:
+	Outline(const MeshData& _mesh, size_t _first, size_t _count) : mesh(&_mesh), first(_first), count(_count) {}
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	Point operator [] (size_t i) const { const float* v = &mesh->vertices[(first + i) * 3]; return Point(v[0], v[1], v[2]); }
+	size_t firstVertex() const { return first; } //index in the mesh
+	const float* data() const { return mesh->vertices.data() + first * 3; } //x, y, z of the points, until the mesh grows again
+
+private:
+	const MeshData* mesh;
+	size_t first;
+	size_t count;
+};
+
+//a mesh drawn once for every offset, like the legs of a table
+struct PlacedMesh
+{
+	std::string name;
+	const MeshData* mesh;
+	std::vector<Point> offsets;
+
+	PlacedMesh(const std::string& _name, const MeshData& _mesh, const std::vector<Point>& _offsets) : name(_name), mesh(&_mesh), offsets(_offsets) {}
+};
+
+struct Arc
+{
+	float radius;
+	Point center;
+	float drawAngle;
+	float startAngle;
+	int segments;
+
+	Arc() { radius = drawAngle = startAngle = 0.0; segments = MAX_CIRCLE_SEGMENTS; }
+	Arc(float _radius, Point _center, float _drawAngle, float _startAngle)
+		: radius(_radius), center(_center), drawAngle(_drawAngle), startAngle(_startAngle), segments(MAX_CIRCLE_SEGMENTS) {}
+};
+
+typedef enum
+{
+	RECTANGLE,
+	OVAL,
+	CIRCLE,
+	TRIANGLE,
+	SQUARE
+}Shape;
+istream& operator >> (istream& is, Shape& shape);
+ostream& operator << (ostream& os, Shape& shape);
+
+void appendGeometry(OUT MeshData& mesh, float* vertices, size_t verticesSize, unsigned int* indices, size_t indicesSize);
+void buildSideWall(OUT MeshData& mesh, unsigned int top, unsigned int bottom, unsigned int count, bool closed);
+void reserveGeometry(OUT MeshData& mesh, size_t vertices, size_t indices); //room for that many more
+Outline buildParallelepiped(OUT MeshData& mesh, float width, float length, float height, Point center = Point(0, 0, 0));
+//maxError is the largest allowed distance between a round outline and its segments, 0 means full detail
+int circleSegments(float radius, float maxError, float drawAngle = 2 * pi);
+int circlePoints(float drawAngle, int segments);
+//writes count points x, y, z of the circle with radius r, the i-th one at startAngle + i * step
+void generateArc(OUT float* vertices, int count, float r, Point center, float startAngle, float step);
+void ovalArcs(float width, float length, Point center, float maxError, OUT Arc arcs[4]);
+Outline buildPartialCircle(OUT MeshData& mesh, float r, Point center = Point(0, 0, 0), float drawAngle = 2 * pi, float startAngle = 0.0, int segments = MAX_CIRCLE_SEGMENTS);
+Outline buildOval(OUT MeshData& mesh, float width, float length, Point center = Point(0, 0, 0), float maxError = 0.0f);
+Outline buildOvalPlot(OUT MeshData& mesh, float width, float length, float height, Point center = Point(0, 0, 0), float maxError = 0.0f);
+Outline buildCylinder(OUT MeshData& mesh, float radius, float height, Point center = Point(0, 0, 0), float maxError = 0.0f);
+std::vector<Point> legCenters(Shape plotShape, float plotWidth, float plotLength, float plotHeight, float legMaxDist, float legHeight);
+//reorder a mesh for the GPU, every step keeps the triangles and only renumbers or reorders them
+const int VERTEX_CACHE_SIZE = 32; //entries of the post transform cache the triangle order is tuned for
+void weldVertices(OUT MeshData& mesh); //merges vertices with identical positions, drops triangles that collapse
+void optimizeVertexCache(OUT MeshData& mesh, int cacheSize = VERTEX_CACHE_SIZE);
+void optimizeVertexFetch(OUT MeshData& mesh); //vertices in the order they are first used
+void optimizeMesh(OUT MeshData& mesh); //all of the above
+float vertexCacheMissRatio(const MeshData& mesh, int cacheSize = VERTEX_CACHE_SIZE); //transformed vertices per triangle
+const unsigned int QUANTIZED_STEPS = 65535; //of the box on every axis
+bool quantizeMesh(const MeshData& mesh, OUT QuantizedMesh& quantized); //false when 16 bit indices can't reach every vertex
+//write the parts as binary STL, OBJ or binary glTF 2.0, exportMesh picks the format by the extension of path.
+//compact only changes glTF, which then keeps the positions and indices of QuantizedMesh
+bool exportSTL(const std::string& path, const std::vector<PlacedMesh>& parts);
+bool exportOBJ(const std::string& path, const std::vector<PlacedMesh>& parts);
+bool exportGLB(const std::string& path, const std::vector<PlacedMesh>& parts, bool compact = false);
+bool exportMesh(const std::string& path, const std::vector<PlacedMesh>& parts, bool compact = false);
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "geometry.h"
+#include "arena.h"
+
+#include <climits>
+#include <cstdint>
+
+//scratch memory of the passes, every pass resets it first, so a thread that optimizes many meshes
+//stops allocating once it has seen the biggest one
+static thread_local Arena scratch;
+
+
+static bool samePosition(const float* a, const float* b)
+{
+	return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+void weldVertices(OUT MeshData& mesh)
+{
+	size_t vertexCount = mesh.vertices.size() / 3;
+	if (vertexCount == 0)
+		return;
+	const float* positions = mesh.vertices.data();
+	scratch.reset();
+
+	//sorting puts equal positions next to each other, the first of them in the buffer stays
+	Span<unsigned int> order = scratch.allocate<unsigned int>(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [positions](unsigned int a, unsigned int b)
+	{
+		const float* p = positions + a * 3;
+		const float* q = positions + b * 3;
+		if (p[0] != q[0])
+			return p[0] < q[0];
+		if (p[1] != q[1])
+			return p[1] < q[1];
+		if (p[2] != q[2])
+			return p[2] < q[2];
+		return a < b;
+	});
+	Span<unsigned int> remap = scratch.allocate<unsigned int>(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		bool duplicate = i > 0 && samePosition(positions + order[i] * 3, positions + order[i - 1] * 3);
+		remap[order[i]] = duplicate ? remap[order[i - 1]] : order[i];
+	}
+
+	//kept vertices move down over the removed ones, in their old order
+	Span<unsigned int> newIndex = scratch.allocate<unsigned int>(vertexCount);
+	size_t kept = 0;
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		if (remap[i] != i)
+			continue;
+		newIndex[i] = kept;
+		for (int k = 0; k < 3; k++)
+		{
+			mesh.vertices[kept * 3 + k] = mesh.vertices[i * 3 + k];
+		}
+		kept++;
+	}
+	mesh.vertices.resize(kept * 3);
+
+	//triangles that lost an edge to the welding cover nothing
+	size_t triangles = 0;
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		unsigned int a = newIndex[remap[mesh.indices[i]]];
+		unsigned int b = newIndex[remap[mesh.indices[i + 1]]];
+		unsigned int c = newIndex[remap[mesh.indices[i + 2]]];
+		if (a == b || b == c || a == c)
+			continue;
+		mesh.indices[triangles * 3] = a;
+		mesh.indices[triangles * 3 + 1] = b;
+		mesh.indices[triangles * 3 + 2] = c;
+		triangles++;
+	}
+	mesh.indices.resize(triangles * 3);
+}
+
+//Tom Forsyth's linear speed vertex cache optimisation: vertices score for being recently used and for
+//having few triangles left, so fans and strips are finished before they fall out of the cache
+static float vertexScore(int cachePosition, unsigned int valence, int cacheSize)
+{
+	if (valence == 0)
+		return -1.0f; //no triangle left to draw
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		//the three vertices of the last triangle score the same, whichever order they were in
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = pow(1.0f - (float)(cachePosition - 3) / (cacheSize - 3), 1.5f);
+	}
+	return score + 2.0f * pow((float)valence, -0.5f);
+}
+
+void optimizeVertexCache(OUT MeshData& mesh, int cacheSize)
+{
+	size_t vertexCount = mesh.vertices.size() / 3;
+	size_t triangleCount = mesh.indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+	const std::vector<unsigned int>& indices = mesh.indices;
+	scratch.reset();
+
+	//triangles of every vertex, vertex v has adjacency[firstTriangle[v]] to adjacency[firstTriangle[v] + valence[v]]
+	Span<unsigned int> valence = scratch.allocate<unsigned int>(vertexCount, 0);
+	Span<unsigned int> firstTriangle = scratch.allocate<unsigned int>(vertexCount + 1, 0);
+	Span<unsigned int> adjacency = scratch.allocate<unsigned int>(triangleCount * 3);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		valence[indices[i]]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		firstTriangle[v + 1] = firstTriangle[v] + valence[v];
+	}
+	Span<unsigned int> fill = scratch.allocate<unsigned int>(vertexCount);
+	std::copy(firstTriangle.begin(), firstTriangle.end() - 1, fill.begin());
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+	}
+
+	Span<int> cachePosition = scratch.allocate<int>(vertexCount, -1);
+	Span<float> vertexScores = scratch.allocate<float>(vertexCount);
+	Span<float> triangleScores = scratch.allocate<float>(triangleCount, 0.0f);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScores[v] = vertexScore(-1, valence[v], cacheSize);
+	}
+	const size_t NO_TRIANGLE = SIZE_MAX;
+	size_t best = 0;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			triangleScores[t] += vertexScores[indices[t * 3 + k]];
+		}
+		if (triangleScores[t] > triangleScores[best])
+			best = t;
+	}
+
+	Span<unsigned char> emitted = scratch.allocate<unsigned char>(triangleCount, 0);
+	Span<unsigned int> result = scratch.allocate<unsigned int>(triangleCount * 3);
+	Span<unsigned int> cache = scratch.allocate<unsigned int>(cacheSize + 3);
+	Span<unsigned int> newCache = scratch.allocate<unsigned int>(cacheSize + 3);
+	size_t cacheCount = 0;
+	size_t scan = 0; //every triangle before it is emitted
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+	{
+		if (best == NO_TRIANGLE)
+		{
+			//nothing in the cache leads on, start again from the first triangle left
+			while (emitted[scan])
+			{
+				scan++;
+			}
+			best = scan;
+		}
+		emitted[best] = 1;
+		const unsigned int* triangle = &indices[best * 3];
+		std::copy(triangle, triangle + 3, &result[emittedCount * 3]);
+
+		//the drawn triangle leaves the lists of its vertices, which move to the front of the cache
+		std::copy(triangle, triangle + 3, newCache.begin());
+		size_t newCount = 3;
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned int v = triangle[k];
+			unsigned int* first = &adjacency[firstTriangle[v]];
+			unsigned int* last = first + valence[v] - 1;
+			*std::find(first, last, (unsigned int)best) = *last;
+			valence[v]--;
+		}
+		for (size_t i = 0; i < cacheCount; i++)
+		{
+			if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+				newCache[newCount++] = cache[i];
+		}
+
+		//new scores for everything that moved, including the vertices pushed out of the cache
+		for (size_t i = 0; i < newCount; i++)
+		{
+			unsigned int v = newCache[i];
+			cachePosition[v] = i < (size_t)cacheSize ? (int)i : -1;
+			float score = vertexScore(cachePosition[v], valence[v], cacheSize);
+			float delta = score - vertexScores[v];
+			vertexScores[v] = score;
+			for (unsigned int j = firstTriangle[v]; j < firstTriangle[v] + valence[v]; j++)
+			{
+				triangleScores[adjacency[j]] += delta;
+			}
+		}
+		cacheCount = std::min(newCount, (size_t)cacheSize);
+		std::swap(cache, newCache);
+
+		//the next triangle is the best one of a cached vertex
+		best = NO_TRIANGLE;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < cacheCount; i++)
+		{
+			unsigned int v = cache[i];
+			for (unsigned int j = firstTriangle[v]; j < firstTriangle[v] + valence[v]; j++)
+			{
+				if (triangleScores[adjacency[j]] > bestScore)
+				{
+					best = adjacency[j];
+					bestScore = triangleScores[adjacency[j]];
+				}
+			}
+		}
+	}
+	std::copy(result.begin(), result.end(), mesh.indices.begin());
+}
+
+void optimizeVertexFetch(OUT MeshData& mesh)
+{
+	//vertices are stored in the order the triangles first use them, unused ones are dropped
+	scratch.reset();
+	Span<unsigned int> remap = scratch.allocate<unsigned int>(mesh.vertices.size() / 3, UINT_MAX);
+	Span<float> vertices = scratch.allocate<float>(mesh.vertices.size());
+	unsigned int next = 0;
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		unsigned int& index = mesh.indices[i];
+		if (remap[index] == UINT_MAX)
+		{
+			std::copy(&mesh.vertices[index * 3], &mesh.vertices[index * 3] + 3, &vertices[next * 3]);
+			remap[index] = next++;
+		}
+		index = remap[index];
+	}
+	std::copy(vertices.begin(), vertices.begin() + next * 3, mesh.vertices.begin());
+	mesh.vertices.resize(next * 3);
+}
+
+void optimizeMesh(OUT MeshData& mesh)
+{
+	weldVertices(OUT mesh);
+	optimizeVertexCache(OUT mesh);
+	optimizeVertexFetch(OUT mesh);
+}
+
+float vertexCacheMissRatio(const MeshData& mesh, int cacheSize)
+{
+	size_t triangleCount = mesh.indices.size() / 3;
+	if (triangleCount == 0)
+		return 0.0f;
+	//a FIFO cache, vertex v is cached while fewer than cacheSize misses came after its own
+	scratch.reset();
+	Span<size_t> missedAt = scratch.allocate<size_t>(mesh.vertices.size() / 3, 0);
+	size_t misses = 0;
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		size_t& at = missedAt[mesh.indices[i]];
+		if (at == 0 || misses - at >= (size_t)cacheSize)
+			at = ++misses;
+	}
+	return (float)misses / triangleCount;
+}
@@ -0,0 +1,44 @@
+#include "geometry.h"
+
+
+bool quantizeMesh(const MeshData& mesh, OUT QuantizedMesh& quantized)
+{
+	size_t vertexCount = mesh.vertices.size() / 3;
+	if (vertexCount == 0 || vertexCount > 65536)
+		return false;
+
+	float minimum[3], maximum[3];
+	for (int k = 0; k < 3; k++)
+	{
+		minimum[k] = maximum[k] = mesh.vertices[k];
+	}
+	for (size_t v = 1; v < vertexCount; v++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			minimum[k] = std::min(minimum[k], mesh.vertices[v * 3 + k]);
+			maximum[k] = std::max(maximum[k], mesh.vertices[v * 3 + k]);
+		}
+	}
+	//a table part is at most a few meters, so a step stays well under 0.1 mm
+	float step[3];
+	for (int k = 0; k < 3; k++)
+	{
+		step[k] = (maximum[k] - minimum[k]) / QUANTIZED_STEPS;
+	}
+	quantized.offset = Point(minimum[0], minimum[1], minimum[2]);
+	quantized.scale = Point(step[0], step[1], step[2]);
+
+	quantized.positions.resize(vertexCount * 4);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			float q = step[k] > 0.0f ? (mesh.vertices[v * 3 + k] - minimum[k]) / step[k] : 0.0f;
+			quantized.positions[v * 4 + k] = (unsigned short)std::min((unsigned int)(q + 0.5f), QUANTIZED_STEPS);
+		}
+		quantized.positions[v * 4 + 3] = 0;
+	}
+	quantized.indices.assign(mesh.indices.begin(), mesh.indices.end());
+	return true;
+}
@@ -0,0 +1,111 @@
+#include "batch.h"
+
+#include <fstream>
+#include <chrono>
+
+
+struct Worker
+{
+	OffscreenContext context;
+	int shaderProgram;
+	Framebuffer framebuffer;
+	bool ready;
+	int rendered;
+
+	Worker() { shaderProgram = 0; ready = false; rendered = 0; }
+};
+
+static void renderSpec(Worker& worker, const std::string& line)
+{
+	TableSpec table;
+	std::string output;
+	if (!parseTable(line, OUT table, OUT output))
+		return;
+
+	if (output.size() < 4 || output.compare(output.size() - 4, 4, ".png") != 0)
+	{
+		//any other output is a model file, written without rendering
+		if (exportTable(output, table))
+			worker.rendered++;
+		return;
+	}
+
+	std::vector<unsigned char> pixels;
+	renderImage(worker.framebuffer, worker.shaderProgram, table, OUT pixels);
+	if (writePNG(output, worker.framebuffer.width, worker.framebuffer.height, pixels))
+		worker.rendered++;
+}
+
+void renderBatch(const std::string& specPath, int threadCount, int width, int height)
+{
+	std::ifstream file(specPath);
+	if (!file)
+	{
+		std::cout << "Failed to open " << specPath << std::endl;
+		return;
+	}
+	std::vector<std::string> specs;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (!line.empty() && line[0] != '#')
+			specs.push_back(line);
+	}
+
+	//contexts are created on this thread (GLFW requires it for the hidden windows)
+	//and handed to the workers, which compile their own shaders once
+	std::vector<Worker> workers(std::max(threadCount, 1));
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		if (!createOffscreenContext(OUT workers[i].context))
+		{
+			workers.resize(i);
+			break;
+		}
+		releaseCurrent(workers[i].context);
+	}
+	if (workers.empty())
+		return;
+
+	auto start = [&workers, width, height](int i)
+	{
+		Worker& worker = workers[i];
+		makeCurrent(worker.context);
+		createShaderProgram(OUT worker.shaderProgram);
+		worker.ready = createFramebuffer(OUT worker.framebuffer, width, height);
+	};
+	auto stop = [&workers](int i)
+	{
+		Worker& worker = workers[i];
+		if (worker.ready)
+			deleteFramebuffer(worker.framebuffer);
+		glDeleteProgram(worker.shaderProgram);
+		glStatsFlush();
+		releaseCurrent(worker.context);
+	};
+
+	auto begin = std::chrono::steady_clock::now();
+	{
+		ThreadPool pool((int)workers.size(), start, stop);
+		for (size_t i = 0; i < specs.size(); i++)
+		{
+			const std::string& spec = specs[i];
+			pool.submit([&workers, &spec](int worker)
+			{
+				if (workers[worker].ready)
+					renderSpec(workers[worker], spec);
+			});
+		}
+		pool.wait();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	int rendered = 0;
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		rendered += workers[i].rendered;
+		makeCurrent(workers[i].context);
+		deleteOffscreenContext(workers[i].context);
+	}
+	std::cout << "Rendered " << rendered << " of " << specs.size() << " tables in " << seconds << " s on " << workers.size() << " threads" << std::endl;
+}
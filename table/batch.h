@@ -0,0 +1,8 @@
+#pragma once
+
+#include "offscreen.h"
+#include "threadpool.h"
+
+//renders every table of the spec file (one parseTable line per table) on a pool of offscreen contexts,
+//outputs that are not .png are exported as models instead
+void renderBatch(const std::string& specPath, int threadCount, int width, int height);
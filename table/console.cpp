@@ -0,0 +1,29 @@
+#include "console.h"
+
+#include <iostream>
+#include <sstream>
+
+
+static thread_local std::ostringstream* held = nullptr; //only the thread that holds writes here
+
+std::ostream& console()
+{
+	if (held != nullptr)
+		return *held;
+	return std::cout;
+}
+
+void holdConsole()
+{
+	if (held == nullptr)
+		held = new std::ostringstream();
+}
+
+void releaseConsole()
+{
+	if (held == nullptr)
+		return;
+	std::cout << held->str() << std::flush;
+	delete held;
+	held = nullptr;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <ostream>
+
+//Where the render code writes its messages. While the questions are asked on another thread,
+//holdConsole keeps the messages of the calling thread back so they don't land in the middle of a prompt.
+std::ostream& console(); //std::cout unless this thread is holding its messages
+void holdConsole();
+void releaseConsole(); //prints what was held
@@ -0,0 +1,49 @@
+#include "framescheduler.h"
+
+#include <algorithm>
+
+
+FrameScheduler::FrameScheduler(GLFWwindow* _window, FrameMode _mode, double maxFps)
+{
+	window = _window;
+	mode = _mode;
+	if (mode == FRAMES_ON_DEMAND && maxFps <= 0.0)
+		maxFps = ON_DEMAND_FPS;
+	interval = mode != FRAMES_VSYNC && maxFps > 0.0 ? 1.0 / maxFps : 0.0;
+	glfwSwapInterval(mode == FRAMES_VSYNC ? 1 : 0); //capped frames are paced here, swapping must not wait as well
+
+	lastFrame = started = glfwGetTime();
+	step = 0.0;
+	requested = 0;
+	animation = 0.0f;
+}
+
+void FrameScheduler::requestFrames(int count)
+{
+	requested = std::max(requested, count);
+}
+
+bool FrameScheduler::idle(bool busy) const
+{
+	//the rotation changes every frame while the window shows it
+	bool visible = !glfwGetWindowAttrib(window, GLFW_ICONIFIED);
+	return !visible && !busy && requested == 0;
+}
+
+void FrameScheduler::wait(bool busy)
+{
+	requested = std::max(requested - 1, 0); //the frame that just ended was one of them
+	glfwPollEvents();
+	if (mode == FRAMES_ON_DEMAND && idle(busy) && !glfwWindowShouldClose(window))
+		glfwWaitEvents(); //whatever woke the window up, being restored, a key or a resize, gets one frame
+	//the rest of the interval is spent handling events, not spinning
+	for (double now = glfwGetTime(); now < lastFrame + interval && !glfwWindowShouldClose(window); now = glfwGetTime())
+	{
+		glfwWaitEventsTimeout(lastFrame + interval - now);
+	}
+
+	double now = glfwGetTime();
+	step = std::min(now - lastFrame, MAX_FRAME_STEP);
+	lastFrame = now;
+	animation = (float)(now - started);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+enum FrameMode
+{
+	FRAMES_CONTINUOUS, //one frame after the other, at most maxFps of them when that is set
+	FRAMES_VSYNC, //one frame per refresh of the display
+	FRAMES_ON_DEMAND //only when something on screen changes, the window sleeps in between
+};
+
+const double ON_DEMAND_FPS = 60.0; //cap of on demand frames while something keeps changing, when no other was given
+const double MAX_FRAME_STEP = 0.1; //seconds one frame may move things, longer gaps come from sleeping
+
+//Decides when the next frame starts and keeps the clock of the rotation.
+//On demand, frames are drawn while the rotation can be seen, while a mesh is being built in the background
+//and for the frames asked for with requestFrames. A minimized window draws nothing and waits in glfwWaitEvents.
+class FrameScheduler
+{
+public:
+	FrameScheduler(GLFWwindow* window, FrameMode mode, double maxFps); //sets the swap interval, 0 fps is no cap
+	void requestFrames(int count = 1); //count more frames are drawn whatever else happens, the running one included
+	void wait(bool busy); //handles events until the next frame is due, busy when background work will need a frame
+	float animationTime() const { return animation; } //seconds the rotation has run, the same for the whole frame
+	float frameStep() const { return step; } //seconds since the frame before, at most MAX_FRAME_STEP
+
+private:
+	GLFWwindow* window;
+	FrameMode mode;
+	double interval; //seconds between frames, 0 without a cap
+	double lastFrame; //when the running frame started
+	double step;
+	int requested;
+	double started;
+	float animation;
+
+	bool idle(bool busy) const; //nothing on screen would change
+};
@@ -0,0 +1,286 @@
+#include "frametimer.h"
+#include "functionality.h"
+
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <iostream>
+
+
+const char *hudVertexShaderSource = "#version 330 core\n"
+"layout (location = 0) in vec2 aPos;\n"
+"layout (location = 1) in vec2 aBar;\n"
+"out vec2 bar;\n"
+"void main()\n"
+"{\n"
+"   gl_Position = vec4(aPos, 0.0, 1.0);\n"
+"   bar = aBar;\n"
+"}\0";
+const char *hudFragmentShaderSource = "#version 330 core\n"
+"in vec2 bar;\n"
+"out vec4 FragColor;\n"
+"void main()\n"
+"{\n"
+"   if (bar.y > 0.5)\n"
+"      FragColor = vec4(0.3f, 0.5f, 0.9f, 1.0f);\n" //GPU
+"   else if (bar.x > 1000.0 / 60.0)\n"
+"      FragColor = vec4(0.9f, 0.2f, 0.2f, 1.0f);\n" //CPU over the 60 fps budget
+"   else\n"
+"      FragColor = vec4(0.2f, 0.8f, 0.3f, 1.0f);\n"
+"}\n\0";
+
+const char* PHASE_NAMES[PHASE_COUNT] = { "input", "upload", "setup", "draw", "swap", "wait" };
+
+//time the frame worked, pacing is left out so a capped frame rate doesn't look like a slow one
+static float cpuTotal(const FrameSample& sample)
+{
+	float total = 0.0f;
+	for (int i = 0; i < PHASE_COUNT; i++)
+	{
+		if (i == PHASE_WAIT)
+			continue;
+		total += sample.cpu[i];
+	}
+	return total;
+}
+
+FrameTimer::FrameTimer(bool _hud)
+{
+	hud = _hud;
+	phase = PHASE_INPUT;
+	titleTime = 0.0;
+	queryRunning = false;
+	glGenQueries(TIMER_QUERIES, queries);
+	for (int i = 0; i < TIMER_QUERIES; i++)
+	{
+		queryFrame[i] = -1;
+	}
+
+	hudProgram = 0;
+	hudVAO = hudVBO = 0;
+	if (hud)
+	{
+		createProgram(hudVertexShaderSource, hudFragmentShaderSource, OUT hudProgram);
+		glGenVertexArrays(1, &hudVAO);
+		glGenBuffers(1, &hudVBO);
+		glBindVertexArray(hudVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, hudVBO);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		glBindVertexArray(0);
+	}
+}
+
+FrameTimer::~FrameTimer()
+{
+	glDeleteQueries(TIMER_QUERIES, queries);
+	if (hud)
+	{
+		glDeleteVertexArrays(1, &hudVAO);
+		glDeleteBuffers(1, &hudVBO);
+		glDeleteProgram(hudProgram);
+	}
+}
+
+void FrameTimer::beginFrame()
+{
+	for (int i = 0; i < PHASE_COUNT; i++)
+	{
+		current.cpu[i] = 0.0f;
+	}
+	current.gpu = -1.0f;
+
+	//this query was last used TIMER_QUERIES frames ago, its result is almost always there by now
+	int query = samples.size() % TIMER_QUERIES;
+	readQuery(query);
+	glBeginQuery(GL_TIME_ELAPSED, queries[query]);
+	queryFrame[query] = (int)samples.size();
+	queryRunning = true;
+
+	phase = PHASE_INPUT;
+	phaseStart = Clock::now();
+}
+
+void FrameTimer::beginPhase(FramePhase next)
+{
+	Clock::time_point now = Clock::now();
+	current.cpu[phase] += std::chrono::duration<float, std::milli>(now - phaseStart).count();
+	phase = next;
+	phaseStart = now;
+	if (next == PHASE_SWAP)
+		endQuery();
+}
+
+void FrameTimer::endQuery()
+{
+	if (!queryRunning)
+		return;
+	glEndQuery(GL_TIME_ELAPSED); //everything the frame sent to the GPU, without the HUD
+	queryRunning = false;
+}
+
+void FrameTimer::endFrame()
+{
+	current.cpu[phase] += std::chrono::duration<float, std::milli>(Clock::now() - phaseStart).count();
+	endQuery(); //a frame that never got to the swap
+	samples.push_back(current);
+}
+
+void FrameTimer::readQuery(int query)
+{
+	if (queryFrame[query] < 0)
+		return;
+	int available = 0;
+	glGetQueryObjectiv(queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available) //otherwise the frame keeps no GPU time instead of stalling
+	{
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[query], GL_QUERY_RESULT, &nanoseconds);
+		samples[queryFrame[query]].gpu = nanoseconds / 1e6f;
+	}
+	queryFrame[query] = -1;
+}
+
+void FrameTimer::drawHud(GLFWwindow* window)
+{
+	if (!hud)
+		return;
+	endQuery(); //the overlay's own draw would make --hud runs slower than the same run without it
+
+	//one CPU and one GPU bar for each of the last HUD_FRAMES frames in the lower left corner
+	const float left = -0.98f, bottom = -0.98f, width = 0.6f, height = 0.3f;
+	const float slot = width / HUD_FRAMES;
+	hudVertices.clear();
+	size_t first = samples.size() > HUD_FRAMES ? samples.size() - HUD_FRAMES : 0;
+	for (size_t i = first; i < samples.size(); i++)
+	{
+		float times[] = { cpuTotal(samples[i]), samples[i].gpu };
+		for (int gpu = 0; gpu < 2; gpu++)
+		{
+			float x0 = left + (i - first) * slot + gpu * slot * 0.45f;
+			float x1 = x0 + slot * 0.45f;
+			float y1 = bottom + std::min(std::max(times[gpu], 0.0f) / HUD_SCALE, 1.0f) * height;
+			float quad[] = { x0, bottom, x1, bottom, x1, y1, x0, bottom, x1, y1, x0, y1 };
+			for (int v = 0; v < 6; v++)
+			{
+				float vertex[] = { quad[v * 2], quad[v * 2 + 1], times[gpu], (float)gpu };
+				hudVertices.insert(hudVertices.end(), vertex, vertex + 4);
+			}
+		}
+	}
+
+	glDisable(GL_DEPTH_TEST);
+	glUseProgram(hudProgram);
+	glBindVertexArray(hudVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, hudVBO);
+	glBufferData(GL_ARRAY_BUFFER, hudVertices.size() * sizeof(float), hudVertices.data(), GL_STREAM_DRAW);
+	glDrawArrays(GL_TRIANGLES, 0, (int)hudVertices.size() / 4);
+	glBindVertexArray(0);
+	glEnable(GL_DEPTH_TEST);
+
+	//the numbers go to the title twice a second, the graph has no text
+	double now = glfwGetTime();
+	if (now - titleTime >= 0.5 && !samples.empty())
+	{
+		titleTime = now;
+		float cpu = 0.0f, gpu = 0.0f;
+		int gpuFrames = 0;
+		for (size_t i = first; i < samples.size(); i++)
+		{
+			cpu += cpuTotal(samples[i]);
+			if (samples[i].gpu >= 0.0f)
+			{
+				gpu += samples[i].gpu;
+				gpuFrames++;
+			}
+		}
+		char title[128];
+		snprintf(title, sizeof(title), "Table - CPU %.2f ms, GPU %.2f ms", cpu / (samples.size() - first), gpuFrames ? gpu / gpuFrames : 0.0f);
+		glfwSetWindowTitle(window, title);
+	}
+}
+
+//every phase, then the CPU total and the GPU time of the frames that have one
+void FrameTimer::column(int index, OUT std::vector<float>& values) const
+{
+	values.clear();
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		if (index < PHASE_COUNT)
+			values.push_back(samples[i].cpu[index]);
+		else if (index == PHASE_COUNT)
+			values.push_back(cpuTotal(samples[i]));
+		else if (samples[i].gpu >= 0.0f)
+			values.push_back(samples[i].gpu);
+	}
+}
+
+static float percentile(std::vector<float>& values, float p)
+{
+	if (values.empty())
+		return -1.0f;
+	size_t n = (size_t)(p * (values.size() - 1) + 0.5f);
+	std::nth_element(values.begin(), values.begin() + n, values.end());
+	return values[n];
+}
+
+bool FrameTimer::writeCSV(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "Failed to write " << path << std::endl;
+		return false;
+	}
+	file << "frame";
+	for (int i = 0; i < PHASE_COUNT; i++)
+	{
+		file << "," << PHASE_NAMES[i];
+	}
+	file << ",cpu,gpu\n";
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		file << i;
+		for (int k = 0; k < PHASE_COUNT; k++)
+		{
+			file << "," << samples[i].cpu[k];
+		}
+		file << "," << cpuTotal(samples[i]) << ",";
+		if (samples[i].gpu >= 0.0f)
+			file << samples[i].gpu;
+		file << "\n";
+	}
+
+	//every column gets its own percentile, so the cpu of these rows is not the sum of their phases
+	const float ps[] = { 0.5f, 0.95f, 0.99f };
+	const char* names[] = { "p50", "p95", "p99" };
+	std::vector<float> values;
+	for (int row = 0; row < 3; row++)
+	{
+		file << names[row];
+		for (int k = 0; k <= PHASE_COUNT + 1; k++)
+		{
+			column(k, OUT values);
+			file << "," << percentile(values, ps[row]);
+		}
+		file << "\n";
+	}
+	return (bool)file;
+}
+
+void FrameTimer::printSummary() const
+{
+	if (samples.empty())
+		return;
+	std::vector<float> values;
+	std::cout << samples.size() << " frames, p50/p99 ms:";
+	for (int k = 0; k <= PHASE_COUNT + 1; k++)
+	{
+		column(k, OUT values);
+		float p50 = percentile(values, 0.5f);
+		std::cout << " " << (k < PHASE_COUNT ? PHASE_NAMES[k] : k == PHASE_COUNT ? "cpu" : "gpu") << " " << p50 << "/" << percentile(values, 0.99f);
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifndef OUT
+#define OUT  //mark out parameters
+#endif
+
+enum FramePhase
+{
+	PHASE_INPUT,
+	PHASE_UPLOAD, //meshes finished by the loader
+	PHASE_SETUP, //clear, camera and model uniforms
+	PHASE_DRAW, //drawTable
+	PHASE_SWAP,
+	PHASE_WAIT, //for the next frame, with a frame cap, vsync or on demand, not part of the CPU total
+	PHASE_COUNT
+};
+
+const int TIMER_QUERIES = 2; //a query is read one frame after it ended, so reading never waits for the GPU
+const int HUD_FRAMES = 120; //frames shown by the overlay graph
+const float HUD_SCALE = 1000.0f / 30; //frame time that fills the graph, 30 fps
+
+struct FrameSample
+{
+	float cpu[PHASE_COUNT]; //milliseconds
+	float gpu; //milliseconds, negative when the query result was not ready in time and got dropped
+};
+
+//CPU phase timers and GL timer queries for every frame, shown in an optional overlay and written to CSV
+class FrameTimer
+{
+public:
+	FrameTimer(bool hud);
+	~FrameTimer();
+	FrameTimer(const FrameTimer&) = delete;
+	FrameTimer& operator = (const FrameTimer&) = delete;
+
+	void beginFrame();
+	void beginPhase(FramePhase phase); //ends the running phase, the GPU query ends with the swap phase or the HUD
+	void endFrame();
+	void drawHud(GLFWwindow* window); //uses its own program, the caller restores its own
+	bool writeCSV(const std::string& path) const; //every frame, then the p50, p95 and p99 rows
+	void printSummary() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	std::vector<FrameSample> samples;
+	FrameSample current;
+	FramePhase phase;
+	Clock::time_point phaseStart;
+	unsigned int queries[TIMER_QUERIES];
+	int queryFrame[TIMER_QUERIES]; //sample index every query measures, -1 when unused
+	bool queryRunning;
+	bool hud;
+	int hudProgram;
+	unsigned int hudVAO, hudVBO;
+	std::vector<float> hudVertices; //x, y, milliseconds and 0 for CPU or 1 for GPU bars
+	double titleTime; //last time the window title got the averages
+
+	void readQuery(int query);
+	void endQuery();
+	void column(int index, OUT std::vector<float>& values) const;
+};
@@ -1,534 +1,703 @@
-#include "functionality.h"
-
-
-const char *vertexShaderSource = "#version 330 core\n"
-"layout (location = 0) in vec3 aPos;\n"
-"uniform mat4 model;\n"
-"uniform mat4 view;\n"
-"uniform mat4 projection;\n"
-"void main()\n"
-"{\n"
-"   gl_Position = projection*view*model*vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
-"}\0";
-const char *fragmentShaderSource = "#version 330 core\n"
-"out vec4 FragColor;\n"
-"void main()\n"
-"{\n"
-"   FragColor = vec4(0.87f, 0.72f, 0.53f, 1.0f);\n"
-"}\n\0";
-
-void processInput(GLFWwindow *window)
-{
-	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-		glfwSetWindowShouldClose(window, true);
-}
-
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
-{
-	glViewport(0, 0, width, height);
-}
-
-void init()
-{
-	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-}
-
-void createWindow(OUT GLFWwindow*& window)
-{
-	window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Table", NULL, NULL);
-	if (window == NULL)
-	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-	}
-	glfwMakeContextCurrent(window);
-	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-	{
-		std::cout << "Failed to initialize GLAD" << std::endl;
-	}
-}
-
-void createShaderProgram(OUT int& shaderProgram)
-{
-	// vertex shader
-	int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	// check for shader compile errors
-	int success;
-	char infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	// fragment shader
-	int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	// check for shader compile errors
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	// link shaders
-	shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	// check for linking errors
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success) {
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-}
-
-void configureBuffersAndDraw(float* _vertices, size_t verticesSize, unsigned int* _indices, size_t indicesSize)
-{
-	float vertices[400];
-	for (int i = 0; i < verticesSize; i++)
-	{
-		vertices[i] = _vertices[i];
-	}
-
-	unsigned int indices[400];
-	for (int i = 0; i < indicesSize; i++)
-	{
-		indices[i] = _indices[i];
-	}
-
-	unsigned int VBO, VAO, EBO;
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &EBO);
-	glBindVertexArray(VAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	glDrawElements(GL_TRIANGLES, indicesSize, GL_UNSIGNED_INT, 0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-	glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &VBO);
-	glDeleteBuffers(1, &EBO);
-}
-
-void drawTetragon(Point p1, Point p2, Point p3, Point p4) 
-{
-	float vertices[] = {
-		p1.x, p1.y, p1.z,
-		p2.x, p2.y, p2.z,
-		p3.x, p3.y, p3.z,
-		p4.x, p4.y, p4.z
-	};
-
-	unsigned int indices[] = {
-		0, 1, 2,
-		1, 2, 3
-	};
-
-	configureBuffersAndDraw(vertices, 12, indices, 6);
-
-}
-
-std::vector<Point> drawParallelepiped(float width, float length, float height, Point center)
-{
-	std::vector<Point> result;
-	float x = width / 2, y = length / 2, z = height / 2;
-	float vertices[] = {
-		-x, -y, -z,
-		x, -y, -z,
-		-x, y, -z,
-		x, y, -z,
-		-x, -y, z,
-		x, -y, z,
-		-x, y, z,
-		x, y, z
-	};
-	for (int i = 0; i < 24; i += 3)
-	{
-		vertices[i] += center.x;
-		vertices[i + 1] += center.y;
-		vertices[i + 2] += center.z;
-	}
-	for (int i = 0; i < 24; i += 3)
-	{
-		result.push_back(Point(vertices[i], vertices[i + 1], vertices[i + 2]));
-	}
-	unsigned int indices[] = {
-		0, 1, 2, //predna stena
-		1, 2, 3,
-		4, 5, 6, //zadna stena
-		5, 6, 7,
-		0, 1, 4, //dolna stena
-		1, 4, 5,
-		2, 3, 6, //gorna stena
-		3, 6, 7,
-		0, 2, 4, //lqva stena
-		2, 4, 6,
-		1, 3, 5, //dqsna stena
-		3, 5, 7
-	};
-
-	configureBuffersAndDraw(vertices, 24, indices, 36);
-
-	return result;
-}
-
-std::vector<Point> drawPartialCircle(float r, Point center, float drawAngle, float startAngle) 
-{
-	std::vector<Point> result;
-	float vertices[303];
-	vertices[0] = vertices[1] = vertices[2] = 0.0;
-	vertices[3] = r; vertices[4] = vertices[5] = 0.0;
-	//rotirame do jelaniq nachalen ugul
-	vertices[3] = cos(startAngle)*r;
-	vertices[4] = sin(startAngle)*r;
-
-	for (int i = 6; i < 303; i += 3)
-	{
-		vertices[i] = cos(drawAngle / 100.0)*vertices[i - 3] - sin(drawAngle / 100.0)*vertices[i - 2];
-		vertices[i + 1] = sin(drawAngle / 100.0)*vertices[i - 3] + cos(drawAngle / 100.0)*vertices[i - 2];
-		vertices[i + 2] = 0.0;
-	}
-
-	for (int i = 0; i < 303; i += 3)
-	{
-		vertices[i] += center.x;
-		vertices[i + 1] += center.y;
-		vertices[i + 2] += center.z;
-	}
-
-	for (int i = 0; i < 303; i += 3)
-	{
-		result.push_back(Point(vertices[i], vertices[i + 1], vertices[i + 2]));
-	}
-
-	unsigned int indices[300];
-	for (int i = 0, j = 1; i < 297; i += 3)
-	{
-		indices[i] = 0;
-		indices[i + 1] = j++;
-		indices[i + 2] = j;
-	}
-	indices[297] = 0;
-	indices[298] = 100;
-	indices[299] = 1;
-
-	configureBuffersAndDraw(vertices, 303, indices, 300);
-
-	return result;
-}
-
-std::vector<Point> drawOval(float width, float length, Point center)
-{
-	std::vector<Point> result, res1, res2, res3, res4;
-	if (width > 1.3*length) 
-		width = 1.3*length;
-	float R = length / 2, r = R / 2, a = width - R - r;
-	res1 = drawPartialCircle(R, center);
-	res2 = drawPartialCircle(r, Point(a + center.x, center.y, center.z));
-	//first
-	float firstCenterY = (pow(a, 2) - pow((R - r), 2)) / (2 * (R - r));
-	float firstRadius = (pow(R, 2) - pow(r, 2) + pow(a, 2)) / (2 * (R - r));
-	float firstDrawAngle = atan(a / firstCenterY);
-	float firstStartAngle = atan(firstCenterY / a);
-	res3 = drawPartialCircle(firstRadius, Point(center.x, -firstCenterY + center.y, center.z), firstDrawAngle, firstStartAngle);
-	//second 
-	float secondCenterY = firstCenterY;
-	float secondRadius = firstRadius;
-	float secondDrawAngle = -firstDrawAngle;
-	float secondStartAngle = -firstStartAngle;
-	res4 = drawPartialCircle(secondRadius, Point(center.x, secondCenterY + center.y, center.z), secondDrawAngle, secondStartAngle);
-
-	for (int i = 0; i < res1.size(); i++)
-	{
-		result.push_back(res1[i]);
-	}
-	for (int i = 0; i < res2.size(); i++)
-	{
-		result.push_back(res2[i]);
-	}
-	for (int i = 0; i < res3.size(); i++)
-	{
-		result.push_back(res3[i]);
-	}
-	for (int i = 0; i < res4.size(); i++)
-	{
-		result.push_back(res4[i]);
-	}
-
-	return result;
-}
-
-std::vector<Point> drawOvalPlot(float width, float length, float height, Point center)
-{
-	std::vector<Point> result, res1, res2;
-
-	res1 = drawOval(width, length, Point(center.x, center.y, center.z + height / 2));
-	res2 = drawOval(width, length, Point(center.x, center.y, center.z - height / 2));
-
-	for (int i = 0; i < res1.size() - 1; i++)
-	{
-		drawTetragon(res1[i], res1[i + 1], res2[i], res2[i + 1]);
-	}
-	drawTetragon(res1[res1.size() - 1], res1[0], res2[res2.size() - 1], res2[0]);
-
-	for (int i = 0; i < res1.size(); i++)
-	{
-		result.push_back(res1[i]);
-	}
-	for (int i = 0; i < res2.size(); i++)
-	{
-		result.push_back(res2[i]);
-	}
-
-	return result;
-}
-
-std::vector<Point> drawCylinder(float radius, float height, Point center)
-{
-	std::vector<Point> result, res1, res2;
-
-	res1 = drawPartialCircle(radius, Point(center.x, center.y, center.z + height / 2));
-	res2 = drawPartialCircle(radius, Point(center.x, center.y, center.z - height / 2));
-	for (int i = 0; i < res1.size() - 1; i++)
-	{
-		drawTetragon(res1[i], res1[i + 1], res2[i], res2[i + 1]);
-	}
-
-	for (int i = 0; i < res1.size(); i++)
-	{
-		result.push_back(res1[i]);
-	}
-	for (int i = 0; i < res2.size(); i++)
-	{
-		result.push_back(res2[i]);
-	}
-	return result;
-}
-
-istream& operator >> (istream& is, Shape& shape)
-{
-	std::string str;
-	is >> str;
-	if (str == "rectangle" || str == "RECTANGLE" || str == "Rectangle" || str == "rect" || str == "Rect" || str == "0")
-		shape = RECTANGLE;
-	if (str == "oval" || str == "OVAL" || str == "Oval" || str == "1")
-		shape = OVAL;
-	if (str == "circle" || str == "CIRCLE" || str == "Circle" || str == "2")
-		shape = CIRCLE;
-	if (str == "triangle" || str == "TRIANGLE" || str == "Triangle" || str == "3")
-		shape = TRIANGLE;
-	if (str == "square" || str == "SQUARE" || str == "Square" || str == "4")
-		shape = SQUARE;
-
-	return is;
-}
-
-ostream& operator << (ostream& os, Shape& shape)
-{
-	switch (shape)
-	{
-	case RECTANGLE: {os << "RECTANGLE"; break; }
-	case OVAL: {os << "OVAL"; break; }
-	case CIRCLE: {os << "CIRCLE"; break; }
-	case TRIANGLE: {os << "TRIANGLE"; break; }
-	case SQUARE: {os << "SQUARE"; break; }
-	}
-
-	return os;
-}
-
-void drawTable(PlotShape& plot, LegShape& leg)
-{
-	float offset = 5.0f + leg.maxDist(); //50 mm offset + offset for center point
-	if (plot.getShape() == RECTANGLE)
-	{
-		plot.draw();
-
-		leg.setCenter(Point(plot.getWidth() / 2 - offset, plot.getLength() / 2 - offset, -plot.getHeight() / 2 - leg.getHeight() / 2));
-		leg.draw();
-		leg.setCenter(Point(-plot.getWidth() / 2 + offset, plot.getLength() / 2 - offset, -plot.getHeight() / 2 - leg.getHeight() / 2));
-		leg.draw();
-		leg.setCenter(Point(plot.getWidth() / 2 - offset, -plot.getLength() / 2 + offset, -plot.getHeight() / 2 - leg.getHeight() / 2));
-		leg.draw();
-		leg.setCenter(Point(-plot.getWidth() / 2 + offset, -plot.getLength() / 2 + offset, -plot.getHeight() / 2 - leg.getHeight() / 2));
-		leg.draw();
-	}
-	if (plot.getShape() == OVAL)
-	{
-		plot.draw();
-
-		leg.setCenter(Point(plot.getWidth() - plot.getLength() / 2 - offset, 0.0, -plot.getHeight() / 2 - leg.getHeight() / 2));
-		leg.draw();
-		leg.setCenter(Point(0.0, plot.getLength() / 2 - offset, -plot.getHeight() / 2 - leg.getHeight() / 2));
-		leg.draw();
-		leg.setCenter(Point(0.0, -plot.getLength() / 2 + offset, -plot.getHeight() / 2 - leg.getHeight() / 2));
-		leg.draw();
-	}
-}
-
-void input(OUT PlotShape*& plot, OUT LegShape*& leg)
-{
-	//1 cm = 1
-	float plotWidth, plotLength, plotHeight = 3.0f; // plotHeight = 30 mm
-	Shape plotShape, legShape;
-	std::cout << "Insert plot shape(valid options are: rectangle and oval): ";
-	std::cin >> plotShape;
-	while (plotShape != RECTANGLE && plotShape != OVAL)
-	{
-		std::cout << "Incorrect plot shape. Insert new plot shape(valid options are: rectangle and oval): ";
-		std::cin >> plotShape;
-	}
-	std::cout << "Insert plot width and length: ";
-	std::cin >> plotWidth >> plotLength;
-	if (plotShape == RECTANGLE)
-	{
-		plot = new RectPlot(plotWidth, plotLength, plotHeight);
-		float legHeight; //must be between 25 and 90 cm
-		std::cout << "Insert legs height: ";
-		std::cin >> legHeight;
-		while (legHeight < 25 || legHeight > 90)
-		{
-			std::cout << "Legs height must be between 25 and 90 cm. Insert new height: ";
-			std::cin >> legHeight;
-		}
-		std::cout << "Insert legs shape(valid options are: square, rectangle and circle): ";
-		std::cin >> legShape;
-		while (legShape != RECTANGLE && legShape != CIRCLE && legShape != SQUARE)
-		{
-			std::cout << "Incorrect legs shape. Insert new legs shape(valid options are: square, rectangle and circle): ";
-			std::cin >> legShape;
-		}
-		if (legShape == SQUARE)
-		{
-			float legWidth;
-			std::cout << "Insert square width: ";
-			std::cin >> legWidth;
-			leg = new RectLeg(legWidth, legWidth, legHeight);
-		}
-		if (legShape == RECTANGLE)
-		{
-			float legWidth, legLength;
-			std::cout << "Insert rectangle width and length: ";
-			std::cin >> legWidth >> legLength;
-			leg = new RectLeg(legWidth, legLength, legHeight);
-		}
-		if (legShape == CIRCLE)
-		{
-			float radius;
-			std::cout << "Insert circle radius: ";
-			std::cin >> radius;
-			leg = new CircleLeg(radius, legHeight);
-		}
-	}
-	if (plotShape == OVAL)
-	{
-
-		plot = new OvalPlot(plotWidth, plotLength, plotHeight);
-		float legHeight; //must be between 25 and 90 cm
-		std::cout << "Insert legs height: ";
-		std::cin >> legHeight;
-		while (legHeight < 25 || legHeight > 90)
-		{
-			std::cout << "Legs height must be between 25 and 90 cm. Insert new height: ";
-			std::cin >> legHeight;
-		}
-		std::cout << "Insert legs shape(valid options are: square, rectangle and circle): ";
-		std::cin >> legShape;
-		while (legShape != RECTANGLE && legShape != CIRCLE && legShape != SQUARE)
-		{
-			std::cout << "Incorrect legs shape. Insert new legs shape(valid options are: square, rectangle and circle): ";
-			std::cin >> legShape;
-		}
-		if (legShape == SQUARE)
-		{
-			float legWidth;
-			std::cout << "Insert square width: ";
-			std::cin >> legWidth;
-			leg = new RectLeg(legWidth, legWidth, legHeight);
-		}
-		if (legShape == RECTANGLE)
-		{
-			float legWidth, legLength;
-			std::cout << "Insert rectangle width and length: ";
-			std::cin >> legWidth >> legLength;
-			leg = new RectLeg(legWidth, legLength, legHeight);
-		}
-		if (legShape == CIRCLE)
-		{
-			float radius;
-			std::cout << "Insert circle radius: ";
-			std::cin >> radius;
-			leg = new CircleLeg(radius, legHeight);
-		}
-	}
-}
-
-void render(GLFWwindow* window, int shaderProgram)
-{
-	glEnable(GL_DEPTH_TEST);
-
-	PlotShape* plot = nullptr;
-	LegShape* leg = nullptr;
-	input(OUT plot, OUT leg);
-
-	while (!glfwWindowShouldClose(window))
-	{
-		processInput(window);
-
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
-
-		glUseProgram(shaderProgram);
-
-		glm::mat4 model;
-		glm::mat4 view;
-		glm::mat4 projection;
-
-		model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(0.0f, 0.0f, 1.0f));
-		view = glm::translate(view, glm::vec3(0.0f, -20.0f, -200.0f));
-		projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
-
-		unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
-		unsigned int viewLoc = glGetUniformLocation(shaderProgram, "view");
-		unsigned int projectionLoc = glGetUniformLocation(shaderProgram, "projection");
-
-		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &model[0][0]);
-		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &view[0][0]);
-		glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, &projection[0][0]);
-
-		drawTable(*plot, *leg);
-
-		glfwSwapBuffers(window);
-		glfwPollEvents();
-	}
-
-	delete plot;
-	delete leg;
-}
-
-void end()
-{
-	glfwTerminate();
+#include "functionality.h"
+#include "indirect.h"
+#include "programcache.h"
+#include "console.h"
+
+#include <cstddef>
+#include <cstring>
+#include <future>
+
+
+const char *vertexShaderSource = "#version 330 core\n"
+"layout (location = 0) in vec3 aPos;\n"
+"layout (location = 1) in vec3 aOffset;\n"
+"layout (location = 2) in vec3 aScale;\n"
+"layout (std140) uniform Camera\n"
+"{\n"
+"   mat4 view;\n"
+"   mat4 projection;\n"
+"};\n"
+"uniform mat4 model;\n"
+"void main()\n"
+"{\n"
+"   gl_Position = projection*view*model*vec4(aPos*aScale + aOffset, 1.0);\n"
+"}\0";
+const char *fragmentShaderSource = "#version 330 core\n"
+"out vec4 FragColor;\n"
+"void main()\n"
+"{\n"
+"   FragColor = vec4(0.87f, 0.72f, 0.53f, 1.0f);\n"
+"}\n\0";
+
+void processInput(GLFWwindow *window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+	Camera* camera = (Camera*)glfwGetWindowUserPointer(window);
+	if (camera != nullptr)
+		setCameraViewport(*camera, width, height);
+}
+
+void init()
+{
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+}
+
+void createWindow(OUT GLFWwindow*& window)
+{
+	window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Table", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+	}
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+	}
+	initProgramCache((GLADloadproc)glfwGetProcAddress);
+	enableParallelShaderCompile((GLADloadproc)glfwGetProcAddress);
+}
+
+bool hasExtension(const char* name)
+{
+	int count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (int i = 0; i < count; i++)
+	{
+		if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+			return true;
+	}
+	return false;
+}
+
+static bool parallelCompile = false;
+
+void enableParallelShaderCompile(GLADloadproc load)
+{
+	typedef void (APIENTRYP MaxShaderCompilerThreads)(GLuint count);
+	MaxShaderCompilerThreads maxShaderCompilerThreads = nullptr;
+	if (hasExtension("GL_KHR_parallel_shader_compile"))
+		maxShaderCompilerThreads = (MaxShaderCompilerThreads)load("glMaxShaderCompilerThreadsKHR");
+	else if (hasExtension("GL_ARB_parallel_shader_compile"))
+		maxShaderCompilerThreads = (MaxShaderCompilerThreads)load("glMaxShaderCompilerThreadsARB");
+	parallelCompile = maxShaderCompilerThreads != nullptr;
+	if (parallelCompile)
+		maxShaderCompilerThreads(0xFFFFFFFF); //as many as the driver likes
+}
+
+void beginProgram(const char* vertexSource, const char* fragmentSource, OUT ProgramBuild& build)
+{
+	build = ProgramBuild();
+	build.vertexSource = vertexSource;
+	build.fragmentSource = fragmentSource;
+	if (loadCachedProgram(vertexSource, fragmentSource, OUT build.program))
+		return;
+	//nothing here asks for a status, so a driver that compiles in the background returns right away
+	build.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(build.vertexShader, 1, &vertexSource, NULL);
+	glCompileShader(build.vertexShader);
+	build.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(build.fragmentShader, 1, &fragmentSource, NULL);
+	glCompileShader(build.fragmentShader);
+	build.program = glCreateProgram();
+	glAttachShader(build.program, build.vertexShader);
+	glAttachShader(build.program, build.fragmentShader);
+	prepareCachedProgram(build.program);
+	glLinkProgram(build.program);
+}
+
+bool isProgramReady(const ProgramBuild& build)
+{
+	if (!parallelCompile || build.vertexShader == 0)
+		return true;
+	int done = 0;
+	glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &done);
+	return done != 0;
+}
+
+bool finishProgram(ProgramBuild& build, OUT int& shaderProgram)
+{
+	shaderProgram = build.program;
+	if (build.vertexShader == 0)
+		return true; //linked when it was loaded
+	// check for shader compile errors
+	int success;
+	char infoLog[512];
+	glGetShaderiv(build.vertexShader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(build.vertexShader, 512, NULL, infoLog);
+		console() << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+	}
+	glGetShaderiv(build.fragmentShader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(build.fragmentShader, 512, NULL, infoLog);
+		console() << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+	}
+	// check for linking errors
+	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+		console() << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+	}
+	glDeleteShader(build.vertexShader);
+	glDeleteShader(build.fragmentShader);
+	build.vertexShader = build.fragmentShader = 0;
+	if (success)
+		saveCachedProgram(build.vertexSource, build.fragmentSource, shaderProgram);
+	return success != 0;
+}
+
+bool createProgram(const char* vertexSource, const char* fragmentSource, OUT int& shaderProgram)
+{
+	ProgramBuild build;
+	beginProgram(vertexSource, fragmentSource, OUT build);
+	return finishProgram(build, OUT shaderProgram);
+}
+
+void beginShaderProgram(OUT ProgramBuild& build)
+{
+	beginProgram(vertexShaderSource, fragmentShaderSource, OUT build);
+}
+
+void finishShaderProgram(ProgramBuild& build, OUT int& shaderProgram)
+{
+	finishProgram(build, OUT shaderProgram);
+
+	//every program reads the camera matrices from the same uniform buffer
+	glUniformBlockBinding(shaderProgram, glGetUniformBlockIndex(shaderProgram, "Camera"), CAMERA_BINDING);
+}
+
+void createShaderProgram(OUT int& shaderProgram)
+{
+	ProgramBuild build;
+	beginShaderProgram(OUT build);
+	finishShaderProgram(build, OUT shaderProgram);
+}
+
+void createCamera(OUT Camera& camera, int width, int height)
+{
+	glGenBuffers(1, &camera.UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, camera.UBO);
+	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BINDING, camera.UBO);
+
+	camera.view = glm::translate(glm::mat4(), glm::vec3(0.0f, -20.0f, -200.0f));
+	setCameraViewport(camera, width, height);
+}
+
+void setCameraViewport(Camera& camera, int width, int height)
+{
+	if (width == 0 || height == 0) //minimized window
+		return;
+	camera.projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 1000.0f);
+	camera.viewportHeight = height;
+	camera.changed = true;
+}
+
+void updateCamera(Camera& camera)
+{
+	if (!camera.changed)
+		return;
+	glBindBuffer(GL_UNIFORM_BUFFER, camera.UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(camera.view));
+	glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(camera.projection));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	camera.changed = false;
+}
+
+void deleteCamera(Camera& camera)
+{
+	glDeleteBuffers(1, &camera.UBO);
+	camera.UBO = 0;
+}
+
+float tessellationError(const Camera& camera, float distance)
+{
+	//size of one pixel at that distance, projection[1][1] is 1 / tan(fov / 2)
+	float pixelSize = 2.0f * std::max(distance, 0.1f) / (camera.projection[1][1] * camera.viewportHeight);
+	float error = MAX_PIXEL_ERROR * pixelSize;
+	//snap to powers of two so small camera moves don't rebuild the meshes
+	return pow(2.0f, floor(log2(error)));
+}
+
+static MeshFormat meshFormat = MESH_FLOAT;
+
+void setMeshFormat(MeshFormat format)
+{
+	meshFormat = format;
+}
+
+MeshFormat getMeshFormat()
+{
+	return meshFormat;
+}
+
+void uploadMesh(const MeshData& data, OUT Mesh& mesh)
+{
+	glGenVertexArrays(1, &mesh.VAO);
+	glGenBuffers(1, &mesh.VBO);
+	glGenBuffers(1, &mesh.EBO);
+	glGenBuffers(1, &mesh.instanceVBO);
+	glBindVertexArray(mesh.VAO);
+
+	QuantizedMesh quantized;
+	if (meshFormat == MESH_COMPACT && quantizeMesh(data, OUT quantized))
+	{
+		//the shader turns the steps back into centimeters with the scale and offset of every instance
+		glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+		glBufferData(GL_ARRAY_BUFFER, quantized.positions.size() * sizeof(unsigned short), quantized.positions.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, quantized.indices.size() * sizeof(unsigned short), quantized.indices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_FALSE, 4 * sizeof(unsigned short), (void*)0);
+		mesh.indexType = GL_UNSIGNED_SHORT;
+		mesh.dequantizeOffset = quantized.offset;
+		mesh.dequantizeScale = quantized.scale;
+	}
+	else
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+		glBufferData(GL_ARRAY_BUFFER, data.vertices.size() * sizeof(float), data.vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(unsigned int), data.indices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	}
+	glEnableVertexAttribArray(0);
+
+	//offsets advance once per instance, not once per vertex
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.instanceVBO);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (void*)offsetof(MeshInstance, offset));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (void*)offsetof(MeshInstance, scale));
+	glVertexAttribDivisor(2, 1);
+	glEnableVertexAttribArray(2);
+
+	//the element buffer binding is part of the VAO state, so only the VAO is unbound
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	mesh.indicesCount = data.indices.size();
+}
+
+void setInstances(OUT Mesh& mesh, const std::vector<Point>& offsets)
+{
+	std::vector<MeshInstance> instances(offsets.size());
+	for (size_t i = 0; i < offsets.size(); i++)
+	{
+		const Point& offset = mesh.dequantizeOffset;
+		instances[i].offset = Point(offsets[i].x + offset.x, offsets[i].y + offset.y, offsets[i].z + offset.z);
+		instances[i].scale = mesh.dequantizeScale;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(MeshInstance), instances.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	mesh.instanceCount = offsets.size();
+}
+
+void drawMesh(const Mesh& mesh)
+{
+	glBindVertexArray(mesh.VAO);
+	glDrawElementsInstanced(GL_TRIANGLES, mesh.indicesCount, mesh.indexType, 0, mesh.instanceCount);
+	glBindVertexArray(0);
+}
+
+void deleteMesh(Mesh& mesh)
+{
+	if (mesh.VAO == 0)
+		return;
+	glDeleteVertexArrays(1, &mesh.VAO);
+	glDeleteBuffers(1, &mesh.VBO);
+	glDeleteBuffers(1, &mesh.EBO);
+	glDeleteBuffers(1, &mesh.instanceVBO);
+	mesh = Mesh();
+}
+
+CachedMesh::~CachedMesh()
+{
+	deleteMesh(mesh);
+}
+
+void CachedMesh::update(float maxError, MeshLoader* loader, Build build)
+{
+	if (mesh.VAO != 0 && error == maxError)
+	{
+		if (pendingError != maxError)
+			generation++; //drops a build for another maxError that is still running
+		pendingError = maxError;
+		return;
+	}
+	if (pendingError == maxError)
+		return; //already being built
+	pendingError = maxError;
+	unsigned int requested = ++generation;
+
+	if (loader == nullptr)
+	{
+		MeshData data;
+		build(OUT data, maxError);
+		optimizeMesh(OUT data);
+		upload(data, maxError);
+		return;
+	}
+	loader->build([build, maxError](OUT MeshData& data) { build(OUT data, maxError); optimizeMesh(OUT data); },
+		[this, maxError, requested](const MeshData& data)
+		{
+			if (generation == requested) //not replaced by a newer request or a change of the shape meanwhile
+				upload(data, maxError);
+		});
+}
+
+void CachedMesh::upload(const MeshData& data, float maxError)
+{
+	deleteMesh(mesh);
+	uploadMesh(data, OUT mesh);
+	error = maxError;
+	stale = false;
+	instancesChanged = true; //the new mesh has an empty instance buffer
+}
+
+void CachedMesh::setInstances(const std::vector<Point>& offsets)
+{
+	if (offsets != instances)
+	{
+		instances = offsets;
+		instancesChanged = true;
+	}
+}
+
+void CachedMesh::invalidate()
+{
+	error = pendingError = -1.0f;
+	generation++; //any build still running is for the old shape and gets dropped
+	stale = true;
+	quietFrames = 0;
+}
+
+void CachedMesh::draw(float maxError, MeshLoader* loader, StreamBuffer* stream, Build build)
+{
+	if (stale && stream != nullptr)
+	{
+		//a shape that keeps changing would rebuild and reallocate its buffers every frame, it is streamed instead
+		//and gets its cached mesh again once it has been quiet for a while
+		if (++quietFrames >= RESIZE_SETTLE_FRAMES)
+			update(maxError, loader, build);
+		streamed.vertices.clear();
+		streamed.indices.clear();
+		build(OUT streamed, maxError);
+		if (stream->draw(streamed, instances))
+			return;
+	}
+	update(maxError, loader, build);
+	draw();
+}
+
+void CachedMesh::draw()
+{
+	if (mesh.VAO == 0)
+		return; //still being built
+	if (instancesChanged)
+	{
+		::setInstances(OUT mesh, instances);
+		instancesChanged = false;
+	}
+	drawMesh(mesh);
+}
+
+void drawTable(const TableSpec& table, TableMeshes& meshes, float maxError, MeshLoader* loader, StreamBuffer* stream)
+{
+	//the builds get copies of the sizes, a background build never sees a table being resized
+	meshes.plot.draw(maxError, loader, stream, [table](OUT MeshData& data, float maxError) { buildPlot(table, OUT data, maxError); });
+	meshes.leg.draw(maxError, loader, stream, [table](OUT MeshData& data, float maxError) { buildLeg(table, OUT data, maxError); }); //all legs in one instanced draw call
+}
+
+bool exportTable(const std::string& path, const TableSpec& table)
+{
+	MeshData plotMesh, legMesh;
+	buildPlot(table, OUT plotMesh, EXPORT_MAX_ERROR);
+	buildLeg(table, OUT legMesh, EXPORT_MAX_ERROR);
+	optimizeMesh(OUT plotMesh);
+	optimizeMesh(OUT legMesh);
+	std::vector<PlacedMesh> parts;
+	parts.push_back(PlacedMesh("plot", plotMesh, std::vector<Point>(1, Point(0, 0, 0))));
+	parts.push_back(PlacedMesh("leg", legMesh, tableLegCenters(table)));
+	return exportMesh(path, parts, getMeshFormat() == MESH_COMPACT);
+}
+
+bool parseShapes(std::istream& is, const std::string& line, OUT TableSpec& table)
+{
+	//<plot shape> <plot width> <plot length> <legs height> <legs shape> <legs size...>
+	//legs size is the width for square, width and length for rectangle and the radius for circle legs
+	float plotWidth, plotLength, plotHeight = 3.0f, legHeight;
+	Shape plotShape = TRIANGLE, legShape = TRIANGLE; //stay invalid if the text is not a shape
+	is >> plotShape >> plotWidth >> plotLength >> legHeight >> legShape;
+	if (!is || (plotShape != RECTANGLE && plotShape != OVAL))
+	{
+		std::cout << "Incorrect plot in \"" << line << "\"" << std::endl;
+		return false;
+	}
+	if (legHeight < 25 || legHeight > 90)
+	{
+		std::cout << "Legs height must be between 25 and 90 cm in \"" << line << "\"" << std::endl;
+		return false;
+	}
+	float legWidth, legLength;
+	if (legShape == SQUARE)
+	{
+		is >> legWidth;
+		legLength = legWidth;
+	}
+	else if (legShape == RECTANGLE)
+		is >> legWidth >> legLength;
+	else if (legShape == CIRCLE)
+		is >> legWidth;
+	else
+	{
+		std::cout << "Incorrect legs shape in \"" << line << "\"" << std::endl;
+		return false;
+	}
+	if (!is)
+	{
+		std::cout << "Missing legs size in \"" << line << "\"" << std::endl;
+		return false;
+	}
+
+	table.plotShape = plotShape;
+	table.plotWidth = plotWidth;
+	table.plotLength = plotLength;
+	table.plotHeight = plotHeight;
+	table.legShape = legShape == CIRCLE ? CIRCLE : RECTANGLE;
+	table.legWidth = legWidth;
+	table.legLength = legShape == CIRCLE ? legWidth : legLength;
+	table.legHeight = legHeight;
+	fitTable(table);
+	return true;
+}
+
+bool parseTable(const std::string& line, OUT TableSpec& table, OUT std::string& output)
+{
+	//<table shapes> <output>
+	std::istringstream is(line);
+	if (!parseShapes(is, line, OUT table))
+		return false;
+	is >> output;
+	if (!is)
+	{
+		std::cout << "Missing output in \"" << line << "\"" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void input(OUT TableSpec& table)
+{
+	//1 cm = 1
+	float plotWidth, plotLength, plotHeight = 3.0f; // plotHeight = 30 mm
+	Shape plotShape, legShape;
+	std::cout << "Insert plot shape(valid options are: rectangle and oval): ";
+	std::cin >> plotShape;
+	while (plotShape != RECTANGLE && plotShape != OVAL)
+	{
+		std::cout << "Incorrect plot shape. Insert new plot shape(valid options are: rectangle and oval): ";
+		std::cin >> plotShape;
+	}
+	std::cout << "Insert plot width and length: ";
+	std::cin >> plotWidth >> plotLength;
+	table.plotShape = plotShape;
+	table.plotWidth = plotWidth;
+	table.plotLength = plotLength;
+	table.plotHeight = plotHeight;
+
+	float legHeight; //must be between 25 and 90 cm
+	std::cout << "Insert legs height: ";
+	std::cin >> legHeight;
+	while (legHeight < 25 || legHeight > 90)
+	{
+		std::cout << "Legs height must be between 25 and 90 cm. Insert new height: ";
+		std::cin >> legHeight;
+	}
+	std::cout << "Insert legs shape(valid options are: square, rectangle and circle): ";
+	std::cin >> legShape;
+	while (legShape != RECTANGLE && legShape != CIRCLE && legShape != SQUARE)
+	{
+		std::cout << "Incorrect legs shape. Insert new legs shape(valid options are: square, rectangle and circle): ";
+		std::cin >> legShape;
+	}
+	table.legHeight = legHeight;
+	if (legShape == SQUARE)
+	{
+		float legWidth;
+		std::cout << "Insert square width: ";
+		std::cin >> legWidth;
+		table.legShape = RECTANGLE;
+		table.legWidth = table.legLength = legWidth;
+	}
+	if (legShape == RECTANGLE)
+	{
+		float legWidth, legLength;
+		std::cout << "Insert rectangle width and length: ";
+		std::cin >> legWidth >> legLength;
+		table.legShape = RECTANGLE;
+		table.legWidth = legWidth;
+		table.legLength = legLength;
+	}
+	if (legShape == CIRCLE)
+	{
+		float radius;
+		std::cout << "Insert circle radius: ";
+		std::cin >> radius;
+		table.legShape = CIRCLE;
+		table.legWidth = table.legLength = radius;
+	}
+	fitTable(table);
+}
+
+void render(GLFWwindow* window, const RenderOptions& options)
+{
+	Scene scene;
+	if (!options.scenePath.empty() && !scene.load(options.scenePath))
+		return;
+	//the questions are answered on their own thread, everything the first frame needs is prepared meanwhile
+	TableSpec table;
+	std::future<void> answers;
+	if (options.scenePath.empty())
+	{
+		holdConsole(); //printed once the questions are answered
+		answers = std::async(std::launch::async, [&table]() { input(OUT table); });
+	}
+
+	ProgramBuild build;
+	beginShaderProgram(OUT build);
+	glEnable(GL_DEPTH_TEST);
+
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	Camera camera;
+	createCamera(OUT camera, width, height);
+	glfwSetWindowUserPointer(window, &camera); //lets framebuffer_size_callback update the projection
+
+	//timing only costs anything when it was asked for
+	FrameTimer* timer = nullptr;
+	if (options.hud || !options.timingPath.empty())
+		timer = new FrameTimer(options.hud);
+
+	//the scene is packed once and every frame only writes commands, table by table drawing is the fallback
+	IndirectRenderer* indirect = nullptr;
+	IndirectFrame frame;
+	if (options.indirect)
+	{
+		indirect = new IndirectRenderer();
+		if (!indirect->create((GLADloadproc)glfwGetProcAddress))
+		{
+			console() << "Drawing table by table" << std::endl;
+			delete indirect;
+			indirect = nullptr;
+		}
+	}
+
+	//tables being resized are drawn from here, without rebuilding their buffers every frame
+	StreamBuffer stream;
+	bool streaming = stream.create((GLADloadproc)glfwGetProcAddress); //otherwise their meshes are rebuilt
+
+	int shaderProgram = 0;
+	bool programReady = false;
+	if (answers.valid())
+	{
+		//the window keeps answering the system, the program is finished (and cached) as soon as the driver is done
+		while (answers.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			if (!programReady && isProgramReady(build))
+			{
+				finishShaderProgram(build, OUT shaderProgram);
+				programReady = true;
+			}
+			glfwWaitEventsTimeout(INPUT_POLL_INTERVAL);
+		}
+		answers.get();
+		releaseConsole();
+		scene.add(table);
+	}
+	if (!programReady)
+		finishShaderProgram(build, OUT shaderProgram);
+	if (indirect != nullptr)
+		indirect->pack(scene);
+
+	glUseProgram(shaderProgram);
+	int modelLoc = glGetUniformLocation(shaderProgram, "model");
+
+	{
+		//meshes are generated off the render thread, the loader is gone before the shapes it builds for
+		MeshLoader loader(std::max((int)std::thread::hardware_concurrency() - 1, 1));
+		FrameScheduler scheduler(window, options.frameMode, options.maxFps);
+		bool firstFrame = true; //builds its meshes right away, so the table is there at once
+		while (!glfwWindowShouldClose(window))
+		{
+			if (timer != nullptr)
+				timer->beginFrame();
+			processInput(window);
+			//the packed scene can't change, a resized table needs frames until its cached mesh is back
+			if (indirect == nullptr && resizeInput(window, scene, scheduler.frameStep()))
+				scheduler.requestFrames(RESIZE_SETTLE_FRAMES + 1);
+			stream.beginFrame();
+
+			if (timer != nullptr)
+				timer->beginPhase(PHASE_UPLOAD);
+			loader.uploadReady(UPLOAD_BUDGET);
+			if (indirect != nullptr)
+				drawSceneIndirect(camera, scene, scheduler.animationTime(), *indirect, OUT frame, timer);
+			else
+				drawScene(camera, modelLoc, scene, scheduler.animationTime(), firstFrame ? nullptr : &loader, timer, streaming ? &stream : nullptr);
+			stream.endFrame();
+			firstFrame = false;
+
+			if (timer != nullptr)
+			{
+				if (options.hud)
+				{
+					timer->drawHud(window);
+					glUseProgram(shaderProgram);
+				}
+				timer->beginPhase(PHASE_SWAP);
+			}
+			glfwSwapBuffers(window);
+			glStatsEndFrame();
+			if (timer != nullptr)
+				timer->beginPhase(PHASE_WAIT);
+			scheduler.wait(loader.busy());
+			if (timer != nullptr)
+				timer->endFrame();
+		}
+	}
+
+	if (timer != nullptr)
+	{
+		if (!options.timingPath.empty())
+			timer->writeCSV(options.timingPath);
+		timer->printSummary();
+		delete timer;
+	}
+	delete indirect;
+
+	glfwSetWindowUserPointer(window, nullptr);
+	deleteCamera(camera);
+	glDeleteProgram(shaderProgram);
+}
+
+void end()
+{
+	glStatsSummary();
+	glfwTerminate();
 }
\ No newline at end of file
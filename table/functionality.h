@@ -1,174 +1,171 @@
-#pragma once
-
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
-
-#include <glm.hpp>
-#include <matrix_transform.hpp>
-#include <type_ptr.hpp>
-#include <matrix_inverse.hpp>
-
-#include <iostream>
-#include <cmath>
-#include <vector>
-#include <string>
-#include <algorithm> //std::max
-
-using std::istream;
-using std::ostream;
-
-#define OUT  //mark out parameters
-
-const unsigned int SCR_WIDTH = 800;
-const unsigned int SCR_HEIGHT = 600;
-const float pi = 3.1415f;
-
-struct Point
-{
-	float x;
-	float y;
-	float z;
-
-	Point() { x = y = z = 0.0; }
-	Point(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
-};
-
-typedef enum
-{
-	RECTANGLE,
-	OVAL,
-	CIRCLE,
-	TRIANGLE,
-	SQUARE
-}Shape;
-istream& operator >> (istream& is, Shape& shape);
-ostream& operator << (ostream& os, Shape& shape);
-
-class PlotShape;
-class LegShape;
-
-void init();
-void createWindow(OUT GLFWwindow*& window);
-void createShaderProgram(OUT int& shaderProgram);
-void configureBuffersAndDraw(float* _vertices, size_t verticesSize, unsigned int* _indices, size_t indicesSize);
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow *window);
-void input(OUT PlotShape*& plot, OUT LegShape*& leg);
-void render(GLFWwindow* window, int shaderProgram);
-void end();
-
-void drawTetragon(Point p1, Point p2, Point p3, Point p4);
-std::vector<Point> drawParallelepiped(float width, float length, float height, Point center = Point(0, 0, 0));
-std::vector<Point> drawPartialCircle(float r, Point center = Point(0, 0, 0), float drawAngle = 2 * pi, float startAngle = 0.0);
-std::vector<Point> drawOval(float width, float length, Point center = Point(0, 0, 0));
-std::vector<Point> drawOvalPlot(float width, float length, float height, Point center = Point(0, 0, 0));
-std::vector<Point> drawCylinder(float radius, float height, Point center = Point(0, 0, 0));
-void drawTable(PlotShape& plot, LegShape& leg);
-
-class PlotShape
-{
-protected:
-	float width;
-	float length;
-	float height;
-	Point center;
-public:
-	virtual Shape getShape() const = 0;
-	virtual float getWidth() const = 0;
-	virtual float getLength() const = 0;
-	virtual float getHeight() const = 0;
-	virtual Point getCenter() const = 0;
-	virtual void draw() const = 0;
-};
-
-class RectPlot : public PlotShape
-{
-public:
-	RectPlot(float _width, float _length, float _height, Point _center = Point(0, 0, 0))
-	{
-		width = _width;
-		length = _length;
-		height = _height;
-		center = _center;
-	}
-	Shape getShape() const { return RECTANGLE; }
-	float getWidth() const { return width; }
-	float getLength() const { return length; }
-	float getHeight() const { return height; }
-	Point getCenter() const { return center; }
-	void draw() const { drawParallelepiped(width, length, height, center); }
-};
-
-class OvalPlot : public PlotShape
-{
-public:
-	OvalPlot(float _width, float _length, float _height, Point _center = Point(0, 0, 0))
-	{
-		width = _width;
-		length = _length;
-		if (width > 1.3*length)
-			width = 1.3*length;
-		height = _height;
-		center = _center;
-	}
-	Shape getShape() const { return OVAL; }
-	float getWidth() const { return width; }
-	float getLength() const { return length; }
-	float getHeight() const { return height; }
-	Point getCenter() const { return center; }
-	void draw() const { drawOvalPlot(width, length, height, center); }
-};
-
-class LegShape
-{
-protected:
-	float height;
-	Point center;
-public:
-	virtual float getHeight() const = 0;
-	virtual Shape getShape() const = 0;
-	virtual float maxDist() const = 0;
-	virtual void setCenter(Point) = 0;
-	virtual void draw() const = 0;
-};
-
-class RectLeg : public LegShape
-{
-private:
-	float width;
-	float length;
-public:
-	RectLeg(float _width, float _length, float _height, Point _center = Point(0, 0, 0))
-	{
-		width = _width;
-		length = _length;
-		height = _height;
-		center = _center;
-	}
-	float getHeight() const { return height; }
-	Shape getShape() const { return RECTANGLE; }
-	float maxDist() const {
-		return //sqrt(pow((width / 2), 2) + pow((length / 2), 2));}
-			std::max(width / 2, length / 2);
-	}
-	void setCenter(Point _center) { center = _center; }
-	void draw() const { drawParallelepiped(width, length, height, center); }
-};
-
-class CircleLeg : public LegShape
-{
-private:
-	float radius;
-public:
-	CircleLeg(float _radius, float _height, Point _center = Point(0, 0, 0))
-	{
-		radius = _radius;
-		height = _height;
-		center = _center;
-	}
-	float getHeight() const { return height; }
-	Shape getShape() const { return CIRCLE; }
-	float maxDist() const { return radius; }
-	void setCenter(Point _center) { center = _center; }
-	void draw() const { drawCylinder(radius, height, center); }
-};
\ No newline at end of file
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "glstats.h"
+
+#include <glm.hpp>
+#include <matrix_transform.hpp>
+#include <type_ptr.hpp>
+#include <matrix_inverse.hpp>
+
+#include "geometry.h"
+#include "meshloader.h"
+#include "frametimer.h"
+#include "streambuffer.h"
+#include "framescheduler.h"
+#include "shapes.h"
+
+#include <sstream>
+
+//KHR_parallel_shader_compile names that the 3.3 glad loader does not know
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const unsigned int CAMERA_BINDING = 0; //uniform buffer binding point of the Camera block
+const float MAX_PIXEL_ERROR = 0.5f; //how far round outlines may stray from the true curve on screen
+const float EXPORT_MAX_ERROR = 0.01f; //0.1 mm, exported files are not tied to a screen
+const double UPLOAD_BUDGET = 0.002; //seconds per frame spent uploading meshes built in the background
+const double INPUT_POLL_INTERVAL = 0.05; //seconds between looks at the console while the window waits for the answers
+
+enum MeshFormat
+{
+	MESH_FLOAT, //3 floats per vertex, 32 bit indices
+	MESH_COMPACT //QuantizedMesh, 8 bytes per vertex and 16 bit indices, for meshes small enough
+};
+
+struct Mesh
+{
+	unsigned int VAO;
+	unsigned int VBO;
+	unsigned int EBO;
+	unsigned int instanceVBO; //one MeshInstance per drawn copy of the mesh
+	size_t indicesCount;
+	size_t instanceCount;
+	unsigned int indexType;
+	Point dequantizeOffset; //0 and 1 for float meshes
+	Point dequantizeScale;
+
+	Mesh() { VAO = VBO = EBO = instanceVBO = 0; indicesCount = instanceCount = 0; indexType = GL_UNSIGNED_INT; dequantizeScale = Point(1, 1, 1); }
+};
+
+//per instance attributes, the offset of the copy together with what turns compact positions back into centimeters
+struct MeshInstance
+{
+	Point offset;
+	Point scale;
+};
+
+//a program whose shaders were handed to the driver, compiled and linked once finishProgram is through
+struct ProgramBuild
+{
+	const char* vertexSource;
+	const char* fragmentSource;
+	int program;
+	int vertexShader; //0 when the program came from the program cache
+	int fragmentShader;
+
+	ProgramBuild() { vertexSource = fragmentSource = nullptr; program = vertexShader = fragmentShader = 0; }
+};
+
+//Mesh of a shape together with the maxError it was built for and where its instances go.
+//A mesh for a new maxError is built right away or, with a loader, in the background while the old one is still drawn.
+//After the shape changes, it is built every frame into a stream buffer until it stops changing.
+class CachedMesh
+{
+public:
+	typedef std::function<void(OUT MeshData& data, float maxError)> Build;
+
+	CachedMesh() { error = pendingError = -1.0f; generation = 0; instancesChanged = true; stale = false; quietFrames = 0; }
+	~CachedMesh();
+	CachedMesh(const CachedMesh&) = delete;
+	CachedMesh& operator = (const CachedMesh&) = delete;
+
+	void update(float maxError, MeshLoader* loader, Build build);
+	void setInstances(const std::vector<Point>& offsets);
+	void draw();
+	void draw(float maxError, MeshLoader* loader, StreamBuffer* stream, Build build); //update and draw
+	void invalidate(); //the shape changed, the mesh has to be built again
+
+private:
+	Mesh mesh;
+	float error; //maxError the mesh was built with
+	float pendingError; //maxError of the newest requested mesh
+	unsigned int generation; //of the newest request, only its build is uploaded
+	std::vector<Point> instances;
+	bool instancesChanged;
+	bool stale; //the mesh is of the shape before it changed
+	int quietFrames; //since it last changed
+	MeshData streamed; //kept, so building into it every frame reuses its memory
+
+	void upload(const MeshData& data, float maxError);
+};
+
+//the cached meshes of one table, the plot is drawn once and the leg once for every leg center
+struct TableMeshes
+{
+	CachedMesh plot;
+	CachedMesh leg;
+
+	explicit TableMeshes(const TableSpec& table) { plot.setInstances(std::vector<Point>(1, Point(0, 0, 0))); leg.setInstances(tableLegCenters(table)); }
+	void resize(const TableSpec& table) { plot.invalidate(); leg.invalidate(); leg.setInstances(tableLegCenters(table)); } //the legs move with the plot
+};
+
+struct RenderOptions
+{
+	bool hud; //frame time graph, averages in the window title
+	std::string timingPath; //CSV with the time of every frame, none when empty
+	std::string scenePath; //tables placed around the room, one table from input when empty
+	bool indirect; //the whole scene in one multi draw indirect call, needs GL 4.3
+	FrameMode frameMode;
+	double maxFps; //cap of continuous and on demand frames, 0 is none
+
+	RenderOptions() { hud = false; indirect = false; frameMode = FRAMES_CONTINUOUS; maxFps = 0.0; }
+};
+
+struct Camera
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	int viewportHeight;
+	unsigned int UBO;
+	bool changed; //view or projection differ from what is in the UBO
+
+	Camera() { viewportHeight = SCR_HEIGHT; UBO = 0; changed = true; }
+};
+
+void init();
+void createWindow(OUT GLFWwindow*& window);
+bool hasExtension(const char* name); //of the current context
+void enableParallelShaderCompile(GLADloadproc load); //lets the driver compile on its own threads, with KHR_parallel_shader_compile
+void beginProgram(const char* vertexSource, const char* fragmentSource, OUT ProgramBuild& build);
+bool isProgramReady(const ProgramBuild& build); //finishProgram won't wait, always true without parallel compiling
+bool finishProgram(ProgramBuild& build, OUT int& shaderProgram);
+bool createProgram(const char* vertexSource, const char* fragmentSource, OUT int& shaderProgram);
+void beginShaderProgram(OUT ProgramBuild& build);
+void finishShaderProgram(ProgramBuild& build, OUT int& shaderProgram);
+void createShaderProgram(OUT int& shaderProgram);
+void createCamera(OUT Camera& camera, int width, int height);
+void setCameraViewport(Camera& camera, int width, int height);
+void updateCamera(Camera& camera);
+void deleteCamera(Camera& camera);
+float tessellationError(const Camera& camera, float distance);
+void setMeshFormat(MeshFormat format); //of the meshes uploaded from now on
+MeshFormat getMeshFormat();
+void uploadMesh(const MeshData& data, OUT Mesh& mesh);
+void setInstances(OUT Mesh& mesh, const std::vector<Point>& offsets);
+void drawMesh(const Mesh& mesh);
+void deleteMesh(Mesh& mesh);
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+bool parseShapes(std::istream& is, const std::string& line, OUT TableSpec& table);
+bool parseTable(const std::string& line, OUT TableSpec& table, OUT std::string& output);
+void input(OUT TableSpec& table);
+void render(GLFWwindow* window, const RenderOptions& options = RenderOptions());
+void end();
+
+void drawTable(const TableSpec& table, TableMeshes& meshes, float maxError, MeshLoader* loader = nullptr, StreamBuffer* stream = nullptr);
+bool exportTable(const std::string& path, const TableSpec& table);
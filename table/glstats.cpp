@@ -0,0 +1,225 @@
+#define GL_STATS_IMPLEMENTATION
+#include "glstats.h"
+
+#ifdef GL_STATS
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <mutex>
+
+const char* STAT_NAMES[STAT_COUNT] = {
+	"GL calls", "buffers created", "buffers deleted", "VAOs created", "VAOs deleted", "programs created", "programs deleted",
+	"uploads", "upload bytes", "draw calls", "triangles", "VAO binds", "redundant VAO binds", "program binds",
+	"redundant program binds", "uniform lookups", "uniform calls"
+};
+
+static thread_local GLCounters pending; //not merged yet
+static thread_local GLCounters frame; //since the last frame ended
+static thread_local GLCounters lastFrame;
+static thread_local GLuint boundVAO = 0;
+static thread_local GLuint boundProgram = 0;
+
+static std::mutex statsMutex;
+static GLCounters totals;
+static GLCounters maximums; //largest count of a single frame
+static long long frames = 0;
+
+static void count(GLStat stat, long long amount = 1)
+{
+	pending.counts[stat] += amount;
+	frame.counts[stat] += amount;
+}
+
+void glStatsFlush()
+{
+	std::lock_guard<std::mutex> lock(statsMutex);
+	for (int i = 0; i < STAT_COUNT; i++)
+	{
+		totals.counts[i] += pending.counts[i];
+	}
+	pending = GLCounters();
+}
+
+void glStatsEndFrame()
+{
+	glStatsFlush();
+	std::lock_guard<std::mutex> lock(statsMutex);
+	frames++;
+	for (int i = 0; i < STAT_COUNT; i++)
+	{
+		maximums.counts[i] = std::max(maximums.counts[i], frame.counts[i]);
+	}
+	lastFrame = frame;
+	frame = GLCounters();
+}
+
+GLCounters glStatsLastFrame()
+{
+	return lastFrame;
+}
+
+void glStatsCount(GLStat stat, long long amount)
+{
+	count(stat, amount);
+}
+
+void glStatsSummary()
+{
+	glStatsFlush();
+	std::lock_guard<std::mutex> lock(statsMutex);
+	std::cout << "GL calls of " << frames << " frames:" << std::endl;
+	std::cout << std::setw(26) << "" << std::setw(14) << "total" << std::setw(14) << "per frame" << std::setw(14) << "max frame" << std::endl;
+	for (int i = 0; i < STAT_COUNT; i++)
+	{
+		std::cout << std::setw(26) << STAT_NAMES[i] << std::setw(14) << totals.counts[i]
+			<< std::setw(14) << (frames ? (double)totals.counts[i] / frames : 0.0) << std::setw(14) << maximums.counts[i] << std::endl;
+	}
+	//whatever is created and never deleted leaks, unless the context goes away with it
+	std::cout << "Alive: " << totals.counts[STAT_BUFFERS_CREATED] - totals.counts[STAT_BUFFERS_DELETED] << " buffers, "
+		<< totals.counts[STAT_VAOS_CREATED] - totals.counts[STAT_VAOS_DELETED] << " VAOs, "
+		<< totals.counts[STAT_PROGRAMS_CREATED] - totals.counts[STAT_PROGRAMS_DELETED] << " programs" << std::endl;
+}
+
+//zero names are ignored by glDelete*, so they are not counted
+static int named(GLsizei n, const GLuint* names)
+{
+	int result = 0;
+	for (GLsizei i = 0; i < n; i++)
+	{
+		if (names[i] != 0)
+			result++;
+	}
+	return result;
+}
+
+void statGenBuffers(GLsizei n, GLuint* buffers)
+{
+	count(STAT_CALLS);
+	count(STAT_BUFFERS_CREATED, n);
+	glGenBuffers(n, buffers);
+}
+
+void statDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	count(STAT_CALLS);
+	count(STAT_BUFFERS_DELETED, named(n, buffers));
+	glDeleteBuffers(n, buffers);
+}
+
+void statGenVertexArrays(GLsizei n, GLuint* arrays)
+{
+	count(STAT_CALLS);
+	count(STAT_VAOS_CREATED, n);
+	glGenVertexArrays(n, arrays);
+}
+
+void statDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+	count(STAT_CALLS);
+	count(STAT_VAOS_DELETED, named(n, arrays));
+	for (GLsizei i = 0; i < n; i++)
+	{
+		if (arrays[i] == boundVAO)
+			boundVAO = 0; //deleting the bound VAO binds 0
+	}
+	glDeleteVertexArrays(n, arrays);
+}
+
+void statBindVertexArray(GLuint array)
+{
+	count(STAT_CALLS);
+	count(STAT_VAO_BINDS);
+	if (array == boundVAO)
+		count(STAT_REDUNDANT_VAO_BINDS);
+	boundVAO = array;
+	glBindVertexArray(array);
+}
+
+GLuint statCreateProgram()
+{
+	count(STAT_CALLS);
+	count(STAT_PROGRAMS_CREATED);
+	return glCreateProgram();
+}
+
+void statDeleteProgram(GLuint program)
+{
+	count(STAT_CALLS);
+	if (program != 0)
+		count(STAT_PROGRAMS_DELETED);
+	glDeleteProgram(program);
+}
+
+void statUseProgram(GLuint program)
+{
+	count(STAT_CALLS);
+	count(STAT_PROGRAM_BINDS);
+	if (program == boundProgram)
+		count(STAT_REDUNDANT_PROGRAM_BINDS);
+	boundProgram = program;
+	glUseProgram(program);
+}
+
+void statBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	count(STAT_CALLS);
+	count(STAT_UPLOADS);
+	count(STAT_UPLOAD_BYTES, size);
+	glBufferData(target, size, data, usage);
+}
+
+void statBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	count(STAT_CALLS);
+	count(STAT_UPLOADS);
+	count(STAT_UPLOAD_BYTES, size);
+	glBufferSubData(target, offset, size, data);
+}
+
+static long long triangles(GLenum mode, GLsizei count)
+{
+	if (mode == GL_TRIANGLES)
+		return count / 3;
+	if (mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN)
+		return std::max(count - 2, 0);
+	return 0;
+}
+
+void statDrawArrays(GLenum mode, GLint first, GLsizei n)
+{
+	count(STAT_CALLS);
+	count(STAT_DRAW_CALLS);
+	count(STAT_TRIANGLES, triangles(mode, n));
+	glDrawArrays(mode, first, n);
+}
+
+void statDrawElements(GLenum mode, GLsizei n, GLenum type, const void* indices)
+{
+	count(STAT_CALLS);
+	count(STAT_DRAW_CALLS);
+	count(STAT_TRIANGLES, triangles(mode, n));
+	glDrawElements(mode, n, type, indices);
+}
+
+void statDrawElementsInstanced(GLenum mode, GLsizei n, GLenum type, const void* indices, GLsizei instanceCount)
+{
+	count(STAT_CALLS);
+	count(STAT_DRAW_CALLS);
+	count(STAT_TRIANGLES, triangles(mode, n) * instanceCount);
+	glDrawElementsInstanced(mode, n, type, indices, instanceCount);
+}
+
+GLint statGetUniformLocation(GLuint program, const GLchar* name)
+{
+	count(STAT_CALLS);
+	count(STAT_UNIFORM_LOOKUPS);
+	return glGetUniformLocation(program, name);
+}
+
+void statUniformMatrix4fv(GLint location, GLsizei n, GLboolean transpose, const GLfloat* value)
+{
+	count(STAT_CALLS);
+	count(STAT_UNIFORM_CALLS);
+	glUniformMatrix4fv(location, n, transpose, value);
+}
+#endif
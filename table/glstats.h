@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glad/glad.h>
+
+//Counts the GL calls that create and delete objects, upload data, draw and set programs and uniforms.
+//Compiled in with GL_STATS (on in Debug builds), without it every function here is an empty inline.
+//Counts are kept per thread and merged when the thread ends a frame, so batch workers are counted too.
+enum GLStat
+{
+	STAT_CALLS, //every counted call
+	STAT_BUFFERS_CREATED,
+	STAT_BUFFERS_DELETED,
+	STAT_VAOS_CREATED,
+	STAT_VAOS_DELETED,
+	STAT_PROGRAMS_CREATED,
+	STAT_PROGRAMS_DELETED,
+	STAT_UPLOADS, //glBufferData and glBufferSubData
+	STAT_UPLOAD_BYTES,
+	STAT_DRAW_CALLS,
+	STAT_TRIANGLES, //of all instances
+	STAT_VAO_BINDS,
+	STAT_REDUNDANT_VAO_BINDS, //of the VAO that was already bound
+	STAT_PROGRAM_BINDS,
+	STAT_REDUNDANT_PROGRAM_BINDS,
+	STAT_UNIFORM_LOOKUPS, //glGetUniformLocation, which belongs in setup and not in frames
+	STAT_UNIFORM_CALLS,
+	STAT_COUNT
+};
+
+struct GLCounters
+{
+	long long counts[STAT_COUNT];
+
+	GLCounters() { for (int i = 0; i < STAT_COUNT; i++) counts[i] = 0; }
+};
+
+#ifdef GL_STATS
+void glStatsFlush(); //merges the counts of this thread without ending a frame
+void glStatsEndFrame();
+GLCounters glStatsLastFrame(); //counts of the last frame ended on this thread
+void glStatsCount(GLStat stat, long long amount = 1); //for calls made through pointers loaded by hand
+void glStatsSummary(); //totals, per frame averages and maximums and the objects still alive
+
+void statGenBuffers(GLsizei n, GLuint* buffers);
+void statDeleteBuffers(GLsizei n, const GLuint* buffers);
+void statGenVertexArrays(GLsizei n, GLuint* arrays);
+void statDeleteVertexArrays(GLsizei n, const GLuint* arrays);
+void statBindVertexArray(GLuint array);
+GLuint statCreateProgram();
+void statDeleteProgram(GLuint program);
+void statUseProgram(GLuint program);
+void statBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+void statBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+void statDrawArrays(GLenum mode, GLint first, GLsizei count);
+void statDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void statDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount);
+GLint statGetUniformLocation(GLuint program, const GLchar* name);
+void statUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+//everything after this header calls the counting versions, glstats.cpp itself calls the real ones
+#ifndef GL_STATS_IMPLEMENTATION
+#undef glGenBuffers
+#define glGenBuffers statGenBuffers
+#undef glDeleteBuffers
+#define glDeleteBuffers statDeleteBuffers
+#undef glGenVertexArrays
+#define glGenVertexArrays statGenVertexArrays
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays statDeleteVertexArrays
+#undef glBindVertexArray
+#define glBindVertexArray statBindVertexArray
+#undef glCreateProgram
+#define glCreateProgram statCreateProgram
+#undef glDeleteProgram
+#define glDeleteProgram statDeleteProgram
+#undef glUseProgram
+#define glUseProgram statUseProgram
+#undef glBufferData
+#define glBufferData statBufferData
+#undef glBufferSubData
+#define glBufferSubData statBufferSubData
+#undef glDrawArrays
+#define glDrawArrays statDrawArrays
+#undef glDrawElements
+#define glDrawElements statDrawElements
+#undef glDrawElementsInstanced
+#define glDrawElementsInstanced statDrawElementsInstanced
+#undef glGetUniformLocation
+#define glGetUniformLocation statGetUniformLocation
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv statUniformMatrix4fv
+#endif
+#else
+inline void glStatsFlush() {}
+inline void glStatsEndFrame() {}
+inline GLCounters glStatsLastFrame() { return GLCounters(); }
+inline void glStatsCount(GLStat stat, long long amount = 1) {}
+inline void glStatsSummary() {}
+#endif
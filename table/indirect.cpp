@@ -0,0 +1,296 @@
+#include "indirect.h"
+#include "console.h"
+
+#include <cstddef>
+#include <map>
+#include <tuple>
+
+
+const char *indirectVertexShaderSource = "#version 430 core\n"
+"layout (location = 0) in vec3 aPos;\n"
+"layout (location = 1) in vec3 aOffset;\n"
+"layout (location = 2) in uint aDraw;\n"
+"layout (location = 3) in vec3 aScale;\n"
+"layout (std140) uniform Camera\n"
+"{\n"
+"   mat4 view;\n"
+"   mat4 projection;\n"
+"};\n"
+"layout (std430, binding = 1) readonly buffer Transforms\n"
+"{\n"
+"   mat4 models[];\n"
+"};\n"
+"void main()\n"
+"{\n"
+"   gl_Position = projection*view*models[aDraw]*vec4(aPos*aScale + aOffset, 1.0);\n"
+"}\0";
+const char *indirectFragmentShaderSource = "#version 430 core\n"
+"out vec4 FragColor;\n"
+"void main()\n"
+"{\n"
+"   FragColor = vec4(0.87f, 0.72f, 0.53f, 1.0f);\n"
+"}\n\0";
+
+IndirectRenderer::IndirectRenderer()
+{
+	multiDrawElementsIndirect = nullptr;
+	program = 0;
+	VAO = VBO = EBO = instanceVBO = commandBuffer = transformBuffer = 0;
+	indexType = GL_UNSIGNED_INT;
+}
+
+IndirectRenderer::~IndirectRenderer()
+{
+	if (VAO == 0)
+		return;
+	glDeleteVertexArrays(1, &VAO);
+	unsigned int buffers[] = { VBO, EBO, instanceVBO, commandBuffer, transformBuffer };
+	glDeleteBuffers(5, buffers);
+	glDeleteProgram(program);
+}
+
+bool IndirectRenderer::create(GLADloadproc load)
+{
+	int major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	if (major < 4 || (major == 4 && minor < 3))
+	{
+		console() << "Indirect drawing needs OpenGL 4.3, the context has " << major << "." << minor << std::endl;
+		return false;
+	}
+	multiDrawElementsIndirect = (MultiDrawElementsIndirect)load("glMultiDrawElementsIndirect");
+	if (multiDrawElementsIndirect == nullptr)
+	{
+		console() << "Failed to load glMultiDrawElementsIndirect" << std::endl;
+		return false;
+	}
+	if (!createProgram(indirectVertexShaderSource, indirectFragmentShaderSource, OUT program))
+		return false;
+	glUniformBlockBinding(program, glGetUniformBlockIndex(program, "Camera"), CAMERA_BINDING);
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+	glGenBuffers(1, &instanceVBO);
+	glGenBuffers(1, &commandBuffer);
+	glGenBuffers(1, &transformBuffer);
+	glBindVertexArray(VAO);
+
+	glEnableVertexAttribArray(0); //its format is set by pack
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+	//instances are found through baseInstance, so every command reads its own offsets and model matrix
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DrawInstance), (void*)offsetof(DrawInstance, offset));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(1);
+	glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(DrawInstance), (void*)offsetof(DrawInstance, draw));
+	glVertexAttribDivisor(2, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(DrawInstance), (void*)offsetof(DrawInstance, scale));
+	glVertexAttribDivisor(3, 1);
+	glEnableVertexAttribArray(3);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return true;
+}
+
+bool IndirectRenderer::addPart(const MeshData& mesh, OUT PackedGeometry& all, OUT Part& part)
+{
+	//indices stay local to the part, baseVertex moves them, so 16 bits are enough for every part
+	if (all.compact)
+	{
+		QuantizedMesh quantized;
+		if (!quantizeMesh(mesh, OUT quantized))
+			return false;
+		part.firstIndex = all.indices.size();
+		part.count = quantized.indices.size();
+		part.baseVertex = all.positions.size() / 4;
+		part.dequantizeOffset = quantized.offset;
+		part.dequantizeScale = quantized.scale;
+		all.positions.insert(all.positions.end(), quantized.positions.begin(), quantized.positions.end());
+		all.indices.insert(all.indices.end(), quantized.indices.begin(), quantized.indices.end());
+		return true;
+	}
+	part.firstIndex = all.floats.indices.size();
+	part.count = mesh.indices.size();
+	part.baseVertex = all.floats.vertices.size() / 3;
+	part.dequantizeOffset = Point(0, 0, 0);
+	part.dequantizeScale = Point(1, 1, 1);
+	all.floats.vertices.insert(all.floats.vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+	all.floats.indices.insert(all.floats.indices.end(), mesh.indices.begin(), mesh.indices.end());
+	return true;
+}
+
+template <class Kind>
+bool IndirectRenderer::packShapes(const ShapeColumns& columns, bool plots, OUT PackedGeometry& all)
+{
+	//tables of the same sizes share their parts, a room of equal tables packs one
+	std::map<std::tuple<float, float, float>, unsigned int> stored;
+	MeshData mesh, previous;
+	for (size_t i = 0; i < columns.table.size(); i++)
+	{
+		unsigned int& index = plots ? packed[columns.table[i]].plot : packed[columns.table[i]].leg;
+		auto found = stored.insert(std::make_pair(std::make_tuple(columns.width[i], columns.length[i], columns.height[i]), (unsigned int)shapes.size()));
+		index = found.first->second;
+		if (!found.second)
+			continue;
+		shapes.push_back(PackedShape());
+		Part* parts = shapes.back().lods;
+		for (int lod = 0; lod < INDIRECT_LODS; lod++)
+		{
+			float maxError = INDIRECT_FINEST_ERROR * pow(4.0f, (float)lod);
+			mesh = MeshData();
+			Kind::build(OUT mesh, columns.width[i], columns.length[i], columns.height[i], maxError);
+			optimizeMesh(OUT mesh);
+			//straight parts and circles already at MIN_CIRCLE_SEGMENTS don't change, they are stored once
+			if (lod > 0 && mesh.indices.size() == previous.indices.size() && mesh.vertices.size() == previous.vertices.size())
+				parts[lod] = parts[lod - 1];
+			else if (!addPart(mesh, OUT all, OUT parts[lod]))
+				return false;
+			std::swap(mesh, previous);
+		}
+	}
+	return true;
+}
+
+bool IndirectRenderer::packTables(const Scene& scene, OUT PackedGeometry& all)
+{
+	const TableCatalog& catalog = scene.getCatalog();
+	shapes.clear();
+	packed.clear();
+	packed.resize(catalog.size());
+	//kind by kind, every loop calls one build function
+	if (!packShapes<RectPlot>(catalog.plots[RectPlot::KIND], true, OUT all) ||
+		!packShapes<OvalPlot>(catalog.plots[OvalPlot::KIND], true, OUT all) ||
+		!packShapes<RectLeg>(catalog.legs[RectLeg::KIND], false, OUT all) ||
+		!packShapes<CircleLeg>(catalog.legs[CircleLeg::KIND], false, OUT all))
+		return false;
+	for (size_t i = 0; i < catalog.size(); i++)
+	{
+		packed[i].plotCenter = std::vector<Point>(1, Point(0, 0, 0));
+		packed[i].legCenters = tableLegCenters(tableSpec(catalog, i));
+	}
+	return true;
+}
+
+void IndirectRenderer::pack(const Scene& scene)
+{
+	PackedGeometry all;
+	all.compact = getMeshFormat() == MESH_COMPACT;
+	if (!packTables(scene, OUT all))
+	{
+		console() << "A part has too many vertices for the compact format, packing floats" << std::endl;
+		all = PackedGeometry();
+		all.compact = false;
+		packTables(scene, OUT all);
+	}
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	if (all.compact)
+	{
+		glBufferData(GL_ARRAY_BUFFER, all.positions.size() * sizeof(unsigned short), all.positions.data(), GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, all.indices.size() * sizeof(unsigned short), all.indices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_FALSE, 4 * sizeof(unsigned short), (void*)0);
+		indexType = GL_UNSIGNED_SHORT;
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, all.floats.vertices.size() * sizeof(float), all.floats.vertices.data(), GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, all.floats.indices.size() * sizeof(unsigned int), all.floats.indices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		indexType = GL_UNSIGNED_INT;
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void IndirectRenderer::addCommand(const Part& part, const std::vector<Point>& offsets, unsigned int draw, OUT IndirectFrame& frame)
+{
+	DrawCommand command;
+	command.count = part.count;
+	command.instanceCount = offsets.size();
+	command.firstIndex = part.firstIndex;
+	command.baseVertex = part.baseVertex;
+	command.baseInstance = frame.instances.size();
+	frame.commands.push_back(command);
+	for (size_t i = 0; i < offsets.size(); i++)
+	{
+		DrawInstance instance;
+		instance.offset = Point(offsets[i].x + part.dequantizeOffset.x, offsets[i].y + part.dequantizeOffset.y, offsets[i].z + part.dequantizeOffset.z);
+		instance.draw = draw;
+		instance.scale = part.dequantizeScale;
+		frame.instances.push_back(instance);
+	}
+}
+
+void IndirectRenderer::generate(const Scene& scene, const Camera& camera, float angle, OUT IndirectFrame& frame) const
+{
+	frame.commands.clear();
+	frame.instances.clear();
+	const TableCatalog& catalog = scene.getCatalog();
+	glm::mat4 viewProjection = camera.projection * camera.view;
+	cullTables(catalog, viewProjection, angle, OUT frame.tables, OUT frame.transforms);
+	for (size_t draw = 0; draw < frame.tables.size(); draw++)
+	{
+		unsigned int i = frame.tables[draw];
+		if (i >= packed.size())
+			break; //added after the scene was packed
+		//the coarsest stored tessellation that is still within the error
+		float maxError = tableError(camera, catalog, i, frame.transforms[draw]);
+		int lod = 0;
+		while (lod + 1 < INDIRECT_LODS && INDIRECT_FINEST_ERROR * pow(4.0f, (float)(lod + 1)) <= maxError)
+		{
+			lod++;
+		}
+
+		addCommand(shapes[packed[i].plot].lods[lod], packed[i].plotCenter, draw, OUT frame);
+		addCommand(shapes[packed[i].leg].lods[lod], packed[i].legCenters, draw, OUT frame);
+	}
+}
+
+void IndirectRenderer::submit(const IndirectFrame& frame)
+{
+	if (frame.commands.empty())
+		return;
+
+	//three uploads and one draw call, whatever the number of tables
+	glUseProgram(program);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, frame.instances.size() * sizeof(DrawInstance), frame.instances.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, transformBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, frame.transforms.size() * sizeof(glm::mat4), frame.transforms.data(), GL_STREAM_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TRANSFORMS_BINDING, transformBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, frame.commands.size() * sizeof(DrawCommand), frame.commands.data(), GL_STREAM_DRAW);
+
+	multiDrawElementsIndirect(GL_TRIANGLES, indexType, 0, frame.commands.size(), 0);
+	glStatsCount(STAT_CALLS);
+	glStatsCount(STAT_DRAW_CALLS);
+	for (size_t i = 0; i < frame.commands.size(); i++)
+	{
+		glStatsCount(STAT_TRIANGLES, (long long)frame.commands[i].count / 3 * frame.commands[i].instanceCount);
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+void drawSceneIndirect(Camera& camera, const Scene& scene, float angle, IndirectRenderer& renderer, OUT IndirectFrame& frame, FrameTimer* timer)
+{
+	if (timer != nullptr)
+		timer->beginPhase(PHASE_SETUP);
+	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	updateCamera(camera); //uploads only after a resize
+	renderer.generate(scene, camera, angle, OUT frame);
+
+	if (timer != nullptr)
+		timer->beginPhase(PHASE_DRAW);
+	renderer.submit(frame);
+}
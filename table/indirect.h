@@ -0,0 +1,105 @@
+#pragma once
+
+#include "scene.h"
+
+//GL 4.3 names that the 3.3 glad loader does not know
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+const int INDIRECT_LODS = 4; //tessellations of every part, each one 4 times coarser
+const float INDIRECT_FINEST_ERROR = 0.0625f; //maxError of the finest one, a power of two like tessellationError
+const unsigned int TRANSFORMS_BINDING = 1; //shader storage binding point of the per draw model matrices
+
+//layout of glMultiDrawElementsIndirect
+struct DrawCommand
+{
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance;
+};
+
+struct DrawInstance
+{
+	Point offset; //of the leg from the table origin, plus the dequantize offset of compact parts
+	unsigned int draw; //index of the model matrix
+	Point scale; //dequantize scale, 1 for float parts
+};
+
+//everything one frame submits, made without GL so it can be generated anywhere
+struct IndirectFrame
+{
+	std::vector<DrawCommand> commands;
+	std::vector<DrawInstance> instances;
+	std::vector<glm::mat4> transforms;
+	std::vector<unsigned int> tables; //the visible ones, in the order of their transforms
+};
+
+//Draws a whole scene with one glMultiDrawElementsIndirect. The parts of all tables are packed in one vertex
+//and one index buffer, once for every size they come in. Every visible table adds a command for its plot
+//and one for its legs.
+class IndirectRenderer
+{
+public:
+	IndirectRenderer();
+	~IndirectRenderer();
+	IndirectRenderer(const IndirectRenderer&) = delete;
+	IndirectRenderer& operator = (const IndirectRenderer&) = delete;
+
+	bool create(GLADloadproc load); //false when the context can't draw indirect
+	void pack(const Scene& scene); //again after tables are added, compact when getMeshFormat() says so
+	void generate(const Scene& scene, const Camera& camera, float angle, OUT IndirectFrame& frame) const;
+	void submit(const IndirectFrame& frame);
+
+private:
+	typedef void (APIENTRYP MultiDrawElementsIndirect)(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride);
+
+	struct Part
+	{
+		unsigned int firstIndex;
+		unsigned int count;
+		int baseVertex;
+		Point dequantizeOffset;
+		Point dequantizeScale;
+	};
+	//every part of the scene in one of the two formats
+	struct PackedGeometry
+	{
+		MeshData floats;
+		std::vector<unsigned short> positions; //QuantizedMesh layout
+		std::vector<unsigned short> indices;
+		bool compact;
+	};
+	//every tessellation of one shape, stored once for all tables with the same sizes
+	struct PackedShape
+	{
+		Part lods[INDIRECT_LODS];
+	};
+	struct PackedTable
+	{
+		unsigned int plot; //in shapes
+		unsigned int leg;
+		std::vector<Point> plotCenter; //one instance
+		std::vector<Point> legCenters;
+	};
+
+	MultiDrawElementsIndirect multiDrawElementsIndirect;
+	int program;
+	unsigned int VAO, VBO, EBO, instanceVBO, commandBuffer, transformBuffer;
+	std::vector<PackedShape> shapes;
+	std::vector<PackedTable> packed;
+	unsigned int indexType;
+
+	static bool addPart(const MeshData& mesh, OUT PackedGeometry& all, OUT Part& part);
+	bool packTables(const Scene& scene, OUT PackedGeometry& all);
+	template <class Kind>
+	bool packShapes(const ShapeColumns& columns, bool plots, OUT PackedGeometry& all); //the plots or the legs of one kind
+	static void addCommand(const Part& part, const std::vector<Point>& offsets, unsigned int draw, OUT IndirectFrame& frame);
+};
+
+void drawSceneIndirect(Camera& camera, const Scene& scene, float angle, IndirectRenderer& renderer, OUT IndirectFrame& frame, FrameTimer* timer = nullptr);
@@ -1,16 +1,83 @@
-﻿#include "functionality.h"
-
-
-int main()
-{
-	GLFWwindow* window;
-	int shaderProgram;
-
-	init();
-	createWindow(OUT window);
-	createShaderProgram(OUT shaderProgram);
-	render(window, shaderProgram);
-	end();
-	
-	return 0;
+﻿#include "functionality.h"
+#include "offscreen.h"
+#include "batch.h"
+#include "programcache.h"
+
+
+int main(int argc, char* argv[])
+{
+	//these go with every mode. --compact: quantized positions and 16 bit indices for everything drawn or exported,
+	//--no-program-cache: compile the shaders every time instead of loading the binaries of an earlier run
+	//they are taken out of argv, so the modes below still find their own arguments by position
+	int kept = 1;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--compact")
+			setMeshFormat(MESH_COMPACT);
+		else if (std::string(argv[i]) == "--no-program-cache")
+			setProgramCacheEnabled(false);
+		else
+			argv[kept++] = argv[i];
+	}
+	argc = kept;
+
+	//table --headless image.png [width height]
+	if (argc >= 3 && std::string(argv[1]) == "--headless")
+	{
+		int width = argc >= 5 ? atoi(argv[3]) : SCR_WIDTH;
+		int height = argc >= 5 ? atoi(argv[4]) : SCR_HEIGHT;
+		renderHeadless(argv[2], width, height);
+		end();
+		return 0;
+	}
+	//table --batch specs.txt [threads [width height]]
+	if (argc >= 3 && std::string(argv[1]) == "--batch")
+	{
+		int threads = argc >= 4 ? atoi(argv[3]) : std::thread::hardware_concurrency();
+		int width = argc >= 6 ? atoi(argv[4]) : SCR_WIDTH;
+		int height = argc >= 6 ? atoi(argv[5]) : SCR_HEIGHT;
+		renderBatch(argv[2], threads, width, height);
+		end();
+		return 0;
+	}
+
+	//table --export table.stl|table.obj|table.glb [--compact]
+	if (argc >= 3 && std::string(argv[1]) == "--export")
+	{
+		TableSpec table;
+		input(OUT table);
+		exportTable(argv[2], table);
+		return 0;
+	}
+
+	//table [--hud] [--timing frames.csv] [--scene tables.txt] [--indirect] [--compact]
+	//      [--vsync | --on-demand] [--fps max]
+	RenderOptions options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--hud")
+			options.hud = true;
+		else if (arg == "--timing" && i + 1 < argc)
+			options.timingPath = argv[++i];
+		else if (arg == "--scene" && i + 1 < argc)
+			options.scenePath = argv[++i];
+		else if (arg == "--indirect")
+			options.indirect = true;
+		else if (arg == "--vsync")
+			options.frameMode = FRAMES_VSYNC;
+		else if (arg == "--on-demand")
+			options.frameMode = FRAMES_ON_DEMAND;
+		else if (arg == "--fps" && i + 1 < argc)
+			options.maxFps = atof(argv[++i]);
+	}
+
+	GLFWwindow* window;
+
+	init();
+	createWindow(OUT window);
+	render(window, options); //compiles the shaders while the questions are answered
+	end();
+	
+	return 0;
 }
\ No newline at end of file
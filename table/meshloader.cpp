@@ -0,0 +1,58 @@
+#include "meshloader.h"
+
+#include <chrono>
+
+
+MeshLoader::MeshLoader(int threadCount)
+	: pool(threadCount), finished(nullptr), pending(0)
+{
+}
+
+MeshLoader::~MeshLoader()
+{
+	pool.wait();
+	uploadReady(0.0); //moves everything that is left to the backlog
+	for (size_t i = 0; i < backlog.size(); i++)
+	{
+		delete backlog[i];
+	}
+}
+
+void MeshLoader::build(Generate generate, Upload upload)
+{
+	pending.fetch_add(1, std::memory_order_relaxed);
+	pool.submit([this, generate, upload](int worker)
+	{
+		Result* result = new Result();
+		generate(OUT result->data);
+		result->upload = upload;
+		result->next = finished.load(std::memory_order_relaxed);
+		while (!finished.compare_exchange_weak(result->next, result, std::memory_order_release, std::memory_order_relaxed));
+	});
+}
+
+int MeshLoader::uploadReady(double budget)
+{
+	//take the whole list at once, so there is no ABA problem, and restore the finishing order
+	Result* taken = finished.exchange(nullptr, std::memory_order_acquire);
+	size_t oldBacklog = backlog.size();
+	for (; taken != nullptr; taken = taken->next)
+	{
+		backlog.insert(backlog.begin() + oldBacklog, taken);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	int uploaded = 0;
+	while (!backlog.empty() && budget > 0.0)
+	{
+		Result* result = backlog.front();
+		backlog.pop_front();
+		result->upload(result->data);
+		delete result;
+		pending.fetch_sub(1, std::memory_order_relaxed);
+		uploaded++;
+		if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget)
+			break; //the rest waits for the next frame
+	}
+	return uploaded;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "geometry.h"
+#include "threadpool.h"
+
+//Builds meshes on worker threads. Finished meshes are pushed on a lock-free list
+//and uploaded on the GL thread by uploadReady, a few at a time so no frame stalls.
+class MeshLoader
+{
+public:
+	typedef std::function<void(OUT MeshData& data)> Generate;
+	typedef std::function<void(const MeshData& data)> Upload;
+
+	MeshLoader(int threadCount);
+	~MeshLoader();
+
+	void build(Generate generate, Upload upload);
+	//uploads finished meshes until budget seconds have passed, returns how many were uploaded
+	int uploadReady(double budget);
+	bool busy() const { return pending.load(std::memory_order_relaxed) > 0; } //built or being built, but not uploaded
+
+private:
+	struct Result
+	{
+		MeshData data;
+		Upload upload;
+		Result* next;
+	};
+
+	ThreadPool pool;
+	std::atomic<Result*> finished; //pushed by the workers, newest first
+	std::deque<Result*> backlog; //taken from finished but not uploaded yet, only used by the GL thread
+	std::atomic<int> pending;
+};
@@ -0,0 +1,346 @@
+#include "offscreen.h"
+#include "programcache.h"
+#include "scene.h"
+
+#include <atomic>
+#include <fstream>
+
+//on Linux the context comes from EGL, which needs no X11/Wayland display,
+//everywhere else a hidden GLFW window provides it
+#ifdef __linux__
+#define USE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+static std::atomic<int> liveContexts(0); //made on the display and not deleted yet
+
+//after a failed createOffscreenContext, terminating the display would also end the contexts of other workers
+static void releaseDisplay(EGLDisplay display)
+{
+	if (liveContexts.load() == 0)
+		eglTerminate(display);
+}
+#endif
+
+bool createOffscreenContext(OUT OffscreenContext& context)
+{
+#ifdef USE_EGL
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != NULL)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+	{
+		std::cout << "Failed to initialize EGL" << std::endl;
+		return false;
+	}
+	const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+	if (extensions == NULL || std::string(extensions).find("EGL_KHR_surfaceless_context") == std::string::npos)
+	{
+		std::cout << "EGL display does not support surfaceless contexts" << std::endl;
+		releaseDisplay(display);
+		return false;
+	}
+
+	EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE, 0, //rendering goes to a framebuffer object, no surface needed
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	eglBindAPI(EGL_OPENGL_API);
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << "Failed to choose EGL config" << std::endl;
+		releaseDisplay(display);
+		return false;
+	}
+
+	EGLint contextAttribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+		EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+		EGL_NONE
+	};
+	EGLContext eglContext = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if (eglContext == EGL_NO_CONTEXT)
+	{
+		std::cout << "Failed to create EGL context" << std::endl;
+		releaseDisplay(display);
+		return false;
+	}
+	liveContexts++;
+	context.display = display;
+	context.context = eglContext;
+	makeCurrent(context);
+
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		deleteOffscreenContext(context);
+		releaseDisplay(display);
+		return false;
+	}
+	initProgramCache((GLADloadproc)eglGetProcAddress);
+#else
+	init();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	context.window = glfwCreateWindow(1, 1, "Table", NULL, NULL);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (context.window == NULL)
+	{
+		std::cout << "Failed to create hidden GLFW window" << std::endl;
+		return false;
+	}
+	makeCurrent(context);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		deleteOffscreenContext(context);
+		return false;
+	}
+	initProgramCache((GLADloadproc)glfwGetProcAddress);
+#endif
+	return true;
+}
+
+void makeCurrent(const OffscreenContext& context)
+{
+#ifdef USE_EGL
+	eglMakeCurrent(context.display, EGL_NO_SURFACE, EGL_NO_SURFACE, context.context);
+#else
+	glfwMakeContextCurrent(context.window);
+#endif
+}
+
+void releaseCurrent(const OffscreenContext& context)
+{
+#ifdef USE_EGL
+	eglMakeCurrent(context.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+#else
+	glfwMakeContextCurrent(NULL);
+#endif
+}
+
+void deleteOffscreenContext(OffscreenContext& context)
+{
+#ifdef USE_EGL
+	if (context.context != nullptr)
+	{
+		//the display stays initialized, other threads may still render on it
+		eglMakeCurrent(context.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(context.display, context.context);
+		liveContexts--;
+	}
+#else
+	if (context.window != nullptr)
+		glfwDestroyWindow(context.window);
+#endif
+	context = OffscreenContext();
+}
+
+bool createFramebuffer(OUT Framebuffer& framebuffer, int width, int height)
+{
+	framebuffer.width = width;
+	framebuffer.height = height;
+	glGenFramebuffers(1, &framebuffer.FBO);
+	glGenRenderbuffers(1, &framebuffer.colorRBO);
+	glGenRenderbuffers(1, &framebuffer.depthRBO);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, framebuffer.colorRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, framebuffer.depthRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.FBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, framebuffer.colorRBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, framebuffer.depthRBO);
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (!complete)
+	{
+		std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE" << std::endl;
+		deleteFramebuffer(framebuffer);
+	}
+	return complete;
+}
+
+void readPixels(const Framebuffer& framebuffer, OUT std::vector<unsigned char>& pixels)
+{
+	int rowSize = framebuffer.width * 3;
+	pixels.resize(rowSize * framebuffer.height);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer.FBO);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, framebuffer.width, framebuffer.height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	//GL rows go bottom to top, image rows top to bottom
+	for (int top = 0, bottom = framebuffer.height - 1; top < bottom; top++, bottom--)
+	{
+		std::swap_ranges(pixels.begin() + top * rowSize, pixels.begin() + (top + 1) * rowSize, pixels.begin() + bottom * rowSize);
+	}
+}
+
+void deleteFramebuffer(Framebuffer& framebuffer)
+{
+	glDeleteFramebuffers(1, &framebuffer.FBO);
+	glDeleteRenderbuffers(1, &framebuffer.colorRBO);
+	glDeleteRenderbuffers(1, &framebuffer.depthRBO);
+	framebuffer = Framebuffer();
+}
+
+struct CrcTable
+{
+	unsigned int values[256];
+};
+
+static constexpr CrcTable makeCrcTable()
+{
+	CrcTable table = {};
+	for (unsigned int i = 0; i < 256; i++)
+	{
+		unsigned int c = i;
+		for (int k = 0; k < 8; k++)
+			c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+		table.values[i] = c;
+	}
+	return table;
+}
+
+static unsigned int crc32(const unsigned char* data, size_t size, unsigned int crc = 0)
+{
+	//filled in by the compiler, batch workers write their images at the same time
+	static constexpr CrcTable table = makeCrcTable();
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++)
+		crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static void putBigEndian(OUT std::vector<unsigned char>& out, unsigned int value)
+{
+	out.push_back(value >> 24);
+	out.push_back((value >> 16) & 0xFF);
+	out.push_back((value >> 8) & 0xFF);
+	out.push_back(value & 0xFF);
+}
+
+static void writeChunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& data)
+{
+	std::vector<unsigned char> chunk;
+	putBigEndian(OUT chunk, data.size());
+	chunk.insert(chunk.end(), type, type + 4);
+	chunk.insert(chunk.end(), data.begin(), data.end());
+	putBigEndian(OUT chunk, crc32(&chunk[4], chunk.size() - 4)); //the crc covers type and data
+	file.write((const char*)chunk.data(), chunk.size());
+}
+
+bool writePNG(const std::string& path, int width, int height, const std::vector<unsigned char>& pixels)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		std::cout << "Failed to open " << path << std::endl;
+		return false;
+	}
+	const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write((const char*)signature, sizeof(signature));
+
+	std::vector<unsigned char> header;
+	putBigEndian(OUT header, width);
+	putBigEndian(OUT header, height);
+	unsigned char format[] = { 8, 2, 0, 0, 0 }; //8 bit RGB, deflate, no interlacing
+	header.insert(header.end(), format, format + 5);
+	writeChunk(file, "IHDR", header);
+
+	//zlib stream with uncompressed deflate blocks, every row starts with filter type 0
+	int rowSize = width * 3;
+	std::vector<unsigned char> raw;
+	raw.reserve((rowSize + 1) * height);
+	for (int y = 0; y < height; y++)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), pixels.begin() + y * rowSize, pixels.begin() + (y + 1) * rowSize);
+	}
+	std::vector<unsigned char> data;
+	data.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+	data.push_back(0x78);
+	data.push_back(0x01);
+	for (size_t first = 0; first < raw.size() || first == 0; first += 65535)
+	{
+		size_t size = std::min(raw.size() - first, (size_t)65535);
+		data.push_back(first + size == raw.size() ? 1 : 0); //last block flag
+		data.push_back(size & 0xFF);
+		data.push_back(size >> 8);
+		data.push_back(~size & 0xFF);
+		data.push_back((~size >> 8) & 0xFF);
+		data.insert(data.end(), raw.begin() + first, raw.begin() + first + size);
+	}
+	unsigned int a = 1, b = 0; //adler32
+	for (size_t i = 0; i < raw.size(); i++)
+	{
+		a = (a + raw[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	putBigEndian(OUT data, (b << 16) | a);
+	writeChunk(file, "IDAT", data);
+	writeChunk(file, "IEND", std::vector<unsigned char>());
+
+	return file.good();
+}
+
+void renderImage(const Framebuffer& framebuffer, int shaderProgram, const TableSpec& table, OUT std::vector<unsigned char>& pixels)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.FBO);
+	glViewport(0, 0, framebuffer.width, framebuffer.height);
+	glEnable(GL_DEPTH_TEST);
+	glUseProgram(shaderProgram);
+
+	Camera camera;
+	createCamera(OUT camera, framebuffer.width, framebuffer.height);
+	int modelLoc = glGetUniformLocation(shaderProgram, "model");
+	{
+		//the same frame as in the window, the meshes are freed while this context is current
+		Scene scene;
+		scene.add(table);
+		drawScene(camera, modelLoc, scene, pi / 6); //turned a bit, so both the plot and the legs are visible
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	readPixels(framebuffer, OUT pixels);
+	deleteCamera(camera);
+	glStatsEndFrame(); //every image is a frame
+}
+
+void renderHeadless(const std::string& path, int width, int height)
+{
+	OffscreenContext context;
+	if (!createOffscreenContext(OUT context))
+		return;
+
+	int shaderProgram;
+	createShaderProgram(OUT shaderProgram);
+	Framebuffer framebuffer;
+	if (createFramebuffer(OUT framebuffer, width, height))
+	{
+		TableSpec table;
+		input(OUT table);
+
+		std::vector<unsigned char> pixels;
+		renderImage(framebuffer, shaderProgram, table, OUT pixels);
+		if (writePNG(path, width, height, pixels))
+			std::cout << "Saved " << path << std::endl;
+
+		deleteFramebuffer(framebuffer);
+	}
+	glDeleteProgram(shaderProgram);
+	deleteOffscreenContext(context);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "functionality.h"
+
+struct OffscreenContext
+{
+	void* display; //EGLDisplay
+	void* context; //EGLContext
+	GLFWwindow* window; //hidden window, used where EGL is not available
+
+	OffscreenContext() { display = context = nullptr; window = nullptr; }
+};
+
+struct Framebuffer
+{
+	int width;
+	int height;
+	unsigned int FBO;
+	unsigned int colorRBO;
+	unsigned int depthRBO;
+
+	Framebuffer() { width = height = 0; FBO = colorRBO = depthRBO = 0; }
+};
+
+bool createOffscreenContext(OUT OffscreenContext& context);
+void makeCurrent(const OffscreenContext& context);
+void releaseCurrent(const OffscreenContext& context);
+void deleteOffscreenContext(OffscreenContext& context);
+bool createFramebuffer(OUT Framebuffer& framebuffer, int width, int height);
+void readPixels(const Framebuffer& framebuffer, OUT std::vector<unsigned char>& pixels);
+void deleteFramebuffer(Framebuffer& framebuffer);
+bool writePNG(const std::string& path, int width, int height, const std::vector<unsigned char>& pixels);
+void renderImage(const Framebuffer& framebuffer, int shaderProgram, const TableSpec& table, OUT std::vector<unsigned char>& pixels);
+void renderHeadless(const std::string& path, int width, int height);
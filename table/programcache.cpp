@@ -0,0 +1,177 @@
+#include "programcache.h"
+#include "functionality.h"
+#include "console.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+typedef void (APIENTRYP GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinary)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+
+static GetProgramBinary getProgramBinary = nullptr;
+static ProgramBinary programBinary = nullptr;
+static ProgramParameteri programParameteri = nullptr;
+static bool cacheEnabled = true;
+
+const unsigned int PROGRAM_CACHE_MAGIC = 0x31435054; //"TPC1", a new layout of the file needs a new one
+
+//written in front of the binary
+struct ProgramCacheHeader
+{
+	unsigned int magic;
+	unsigned int format;
+	unsigned long long key; //again, in case two keys ever share a file name
+	unsigned long long length;
+};
+
+
+void initProgramCache(GLADloadproc load)
+{
+	getProgramBinary = nullptr;
+	programBinary = nullptr;
+	programParameteri = nullptr;
+	int major = 0, minor = 0, formats = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	if (!(major > 4 || (major == 4 && minor >= 1) || hasExtension("GL_ARB_get_program_binary")))
+		return;
+	//drivers that can't write any binary say so with no formats
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats == 0)
+		return;
+	getProgramBinary = (GetProgramBinary)load("glGetProgramBinary");
+	programBinary = (ProgramBinary)load("glProgramBinary");
+	programParameteri = (ProgramParameteri)load("glProgramParameteri");
+	if (getProgramBinary == nullptr || programBinary == nullptr || programParameteri == nullptr)
+		getProgramBinary = nullptr;
+}
+
+void setProgramCacheEnabled(bool enabled)
+{
+	cacheEnabled = enabled;
+}
+
+static bool available()
+{
+	return cacheEnabled && getProgramBinary != nullptr;
+}
+
+static void hash(OUT unsigned long long& h, const char* text)
+{
+	//FNV-1a, the terminator goes in too so "ab" + "c" and "a" + "bc" differ
+	do
+	{
+		h = (h ^ (unsigned char)*text) * 1099511628211ull;
+	} while (*text++ != '\0');
+}
+
+static unsigned long long programKey(const char* vertexSource, const char* fragmentSource)
+{
+	unsigned long long h = 14695981039346656037ull;
+	hash(OUT h, (const char*)glGetString(GL_VENDOR));
+	hash(OUT h, (const char*)glGetString(GL_RENDERER));
+	hash(OUT h, (const char*)glGetString(GL_VERSION));
+	hash(OUT h, vertexSource);
+	hash(OUT h, fragmentSource);
+	return h;
+}
+
+static std::string programPath(unsigned long long key)
+{
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", key);
+	return std::string(PROGRAM_CACHE_PREFIX) + name + ".bin";
+}
+
+bool loadCachedProgram(const char* vertexSource, const char* fragmentSource, OUT int& program)
+{
+	if (!available())
+		return false;
+	unsigned long long key = programKey(vertexSource, fragmentSource);
+	std::string path = programPath(key);
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false; //first run with this driver and these sources
+
+	ProgramCacheHeader header;
+	std::vector<char> binary;
+	bool valid = (bool)file.read((char*)&header, sizeof(header)) && header.magic == PROGRAM_CACHE_MAGIC &&
+		header.key == key && header.length > 0 && header.length < (1u << 30);
+	if (valid)
+	{
+		binary.resize(header.length);
+		valid = file.read(binary.data(), binary.size()) && file.peek() == EOF;
+	}
+	file.close();
+
+	int success = 0;
+	if (valid)
+	{
+		program = glCreateProgram();
+		programBinary(program, header.format, binary.data(), binary.size());
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+			glDeleteProgram(program);
+	}
+	if (!success)
+	{
+		//cut short or no longer accepted by the driver, the caller compiles and writes a new one
+		console() << "Ignoring stale program binary " << path << std::endl;
+		std::remove(path.c_str());
+		program = 0;
+	}
+	return success != 0;
+}
+
+void prepareCachedProgram(int program)
+{
+	if (available())
+		programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void saveCachedProgram(const char* vertexSource, const char* fragmentSource, int program)
+{
+	if (!available())
+		return;
+	int length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	getProgramBinary(program, length, &length, &format, binary.data());
+	if (length <= 0)
+		return;
+
+	ProgramCacheHeader header;
+	header.magic = PROGRAM_CACHE_MAGIC;
+	header.format = format;
+	header.key = programKey(vertexSource, fragmentSource);
+	header.length = length;
+
+	//batch runs start many processes at once, each writes its own file and renames it, so nobody
+	//ever reads a half written binary
+	std::string path = programPath(header.key);
+	std::ostringstream temporary;
+	temporary << path << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << "."
+		<< std::chrono::steady_clock::now().time_since_epoch().count() << ".tmp";
+	{
+		std::ofstream file(temporary.str(), std::ios::binary);
+		if (!file.write((const char*)&header, sizeof(header)) || !file.write(binary.data(), length))
+		{
+			file.close();
+			std::remove(temporary.str().c_str());
+			return;
+		}
+	}
+	//fails where another run was faster, its binary is just as good
+	if (std::rename(temporary.str().c_str(), path.c_str()) != 0)
+		std::remove(temporary.str().c_str());
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "glstats.h"
+
+#include <string>
+
+#ifndef OUT
+#define OUT
+#endif
+
+//GL 4.1 names that the 3.3 glad loader does not know
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+const char PROGRAM_CACHE_PREFIX[] = "program-"; //cached programs are program-<key>.bin in the working directory
+
+//Keeps linked programs on disk with glGetProgramBinary, so later runs skip compiling and linking.
+//The key hashes the vendor, renderer and version strings of the driver together with both sources,
+//so a new driver or a changed shader never loads an old binary. A binary the driver turns down
+//is deleted and the program is compiled again.
+void initProgramCache(GLADloadproc load); //after every gladLoadGLLoader, does nothing without GL 4.1 or ARB_get_program_binary
+void setProgramCacheEnabled(bool enabled);
+bool loadCachedProgram(const char* vertexSource, const char* fragmentSource, OUT int& program);
+void prepareCachedProgram(int program); //before glLinkProgram, some drivers only keep the binary when asked to
+void saveCachedProgram(const char* vertexSource, const char* fragmentSource, int program);
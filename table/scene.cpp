@@ -0,0 +1,317 @@
+#include "scene.h"
+
+#include <fstream>
+#include <limits>
+
+
+Scene::~Scene()
+{
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		if (meshes[i] != nullptr && --meshes[i]->users == 0)
+			delete meshes[i];
+	}
+}
+
+void Scene::add(const TableSpec& table, Point position, float angle)
+{
+	size_t index = addTable(catalog, table, position, angle);
+	tableBounds(tableSpec(catalog, index), OUT catalog.boundsMin[index], OUT catalog.boundsMax[index]);
+	meshes.push_back(nullptr);
+}
+
+bool Scene::load(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		std::cout << "Failed to open " << path << std::endl;
+		return false;
+	}
+	//<x> <y> <angle in degrees> <table shapes>, one table per line
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream is(line);
+		float x, y, angle;
+		is >> x >> y >> angle;
+		TableSpec table;
+		if (!is)
+			std::cout << "Incorrect position in \"" << line << "\"" << std::endl;
+		else if (parseShapes(is, line, OUT table))
+			addTable(catalog, table, Point(x, y, 0.0f), glm::radians(angle));
+	}
+	updateBounds(catalog);
+	meshes.resize(catalog.size(), nullptr);
+	return catalog.size() > 0;
+}
+
+void Scene::resize(size_t index, float width, float length)
+{
+	width = std::min(std::max(width, MIN_PLOT_SIZE), MAX_PLOT_SIZE);
+	length = std::min(std::max(length, MIN_PLOT_SIZE), MAX_PLOT_SIZE);
+	SpecKey before = specKey(tableSpec(catalog, index));
+	resizeTable(catalog, index, width, length);
+	SharedMeshes*& table = meshes[index];
+	if (table == nullptr)
+		return;
+	if (table->keyed)
+	{
+		//the other tables keep the old size, this one gets meshes of its own
+		if (table->users == 1)
+			shared.erase(before);
+		else
+		{
+			table->users--;
+			table = new SharedMeshes(tableSpec(catalog, index));
+		}
+		table->keyed = false;
+	}
+	table->meshes.resize(tableSpec(catalog, index));
+}
+
+SharedMeshes* Scene::findMeshes(size_t index)
+{
+	TableSpec table = tableSpec(catalog, index);
+	SpecKey key = specKey(table);
+	std::map<SpecKey, SharedMeshes*>::iterator found = shared.find(key);
+	if (found != shared.end())
+	{
+		found->second->users++;
+		return found->second;
+	}
+	SharedMeshes* created = new SharedMeshes(table); //the leg centers are set once, not every frame
+	shared[key] = created;
+	return created;
+}
+
+SpecKey specKey(const TableSpec& table)
+{
+	return SpecKey(table.plotShape, table.plotWidth, table.plotLength, table.plotHeight, table.legShape, table.legWidth, table.legLength, table.legHeight);
+}
+
+static void appendShape(OUT ShapeColumns& columns, float width, float length, float height, size_t table)
+{
+	columns.width.push_back(width);
+	columns.length.push_back(length);
+	columns.height.push_back(height);
+	columns.table.push_back(table);
+}
+
+size_t addTable(TableCatalog& catalog, const TableSpec& spec, Point position, float angle)
+{
+	TableSpec table = spec;
+	fitTable(table);
+	size_t index = catalog.size();
+	int plot = plotKind(table.plotShape), leg = legKind(table.legShape);
+	catalog.position.push_back(position);
+	catalog.angle.push_back(angle);
+	catalog.boundsMin.push_back(glm::vec3(0.0f));
+	catalog.boundsMax.push_back(glm::vec3(0.0f));
+	catalog.plotKind.push_back(plot);
+	catalog.plotSlot.push_back(catalog.plots[plot].table.size());
+	catalog.legKind.push_back(leg);
+	catalog.legSlot.push_back(catalog.legs[leg].table.size());
+	appendShape(OUT catalog.plots[plot], table.plotWidth, table.plotLength, table.plotHeight, index);
+	appendShape(OUT catalog.legs[leg], table.legWidth, table.legLength, table.legHeight, index);
+	return index;
+}
+
+TableSpec tableSpec(const TableCatalog& catalog, size_t index)
+{
+	TableSpec table;
+	const ShapeColumns& plots = catalog.plots[catalog.plotKind[index]];
+	unsigned int plot = catalog.plotSlot[index];
+	table.plotShape = PLOT_SHAPES[catalog.plotKind[index]];
+	table.plotWidth = plots.width[plot];
+	table.plotLength = plots.length[plot];
+	table.plotHeight = plots.height[plot];
+	const ShapeColumns& legs = catalog.legs[catalog.legKind[index]];
+	unsigned int leg = catalog.legSlot[index];
+	table.legShape = LEG_SHAPES[catalog.legKind[index]];
+	table.legWidth = legs.width[leg];
+	table.legLength = legs.length[leg];
+	table.legHeight = legs.height[leg];
+	return table;
+}
+
+void resizeTable(TableCatalog& catalog, size_t index, float width, float length)
+{
+	TableSpec table = tableSpec(catalog, index);
+	table.plotWidth = width;
+	table.plotLength = length;
+	fitTable(table);
+	ShapeColumns& plots = catalog.plots[catalog.plotKind[index]];
+	plots.width[catalog.plotSlot[index]] = table.plotWidth;
+	plots.length[catalog.plotSlot[index]] = table.plotLength;
+	tableBounds(table, OUT catalog.boundsMin[index], OUT catalog.boundsMax[index]);
+}
+
+//box of the plot alone, the legs stand inside its outline, so only their height adds to it
+template <class Plot>
+static void plotBox(float width, float length, float height, OUT glm::vec3& boundsMin, OUT glm::vec3& boundsMax)
+{
+	float minX, maxX;
+	Plot::extent(width, length, OUT minX, OUT maxX);
+	boundsMin = glm::vec3(minX, -length / 2, -height / 2);
+	boundsMax = glm::vec3(maxX, length / 2, height / 2);
+}
+
+template <class Plot>
+static void plotBounds(const ShapeColumns& plots, OUT TableCatalog& catalog)
+{
+	for (size_t i = 0; i < plots.table.size(); i++)
+	{
+		unsigned int table = plots.table[i];
+		plotBox<Plot>(plots.width[i], plots.length[i], plots.height[i], OUT catalog.boundsMin[table], OUT catalog.boundsMax[table]);
+	}
+}
+
+void updateBounds(TableCatalog& catalog)
+{
+	plotBounds<RectPlot>(catalog.plots[RectPlot::KIND], OUT catalog);
+	plotBounds<OvalPlot>(catalog.plots[OvalPlot::KIND], OUT catalog);
+	for (int kind = 0; kind < LEG_KINDS; kind++)
+	{
+		const ShapeColumns& legs = catalog.legs[kind];
+		for (size_t i = 0; i < legs.table.size(); i++)
+		{
+			catalog.boundsMin[legs.table[i]].z -= legs.height[i];
+		}
+	}
+}
+
+void tableBounds(const TableSpec& table, OUT glm::vec3& boundsMin, OUT glm::vec3& boundsMax)
+{
+	if (table.plotShape == OvalPlot::SHAPE)
+		plotBox<OvalPlot>(table.plotWidth, table.plotLength, table.plotHeight, OUT boundsMin, OUT boundsMax);
+	else
+		plotBox<RectPlot>(table.plotWidth, table.plotLength, table.plotHeight, OUT boundsMin, OUT boundsMax);
+	boundsMin.z -= table.legHeight;
+}
+
+glm::mat4 roomModel(float sceneAngle)
+{
+	//z up table coordinates to the y up world, then the room turn
+	glm::mat4 model;
+	model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	return glm::rotate(model, sceneAngle, glm::vec3(0.0f, 0.0f, 1.0f));
+}
+
+glm::mat4 tableModel(const glm::mat4& room, Point position, float tableAngle)
+{
+	//the place and the turn of the table
+	glm::mat4 model = glm::translate(room, glm::vec3(position.x, position.y, position.z));
+	return glm::rotate(model, tableAngle, glm::vec3(0.0f, 0.0f, 1.0f));
+}
+
+void cullTables(const TableCatalog& catalog, const glm::mat4& viewProjection, float angle, OUT std::vector<unsigned int>& visible, OUT std::vector<glm::mat4>& models)
+{
+	visible.clear();
+	models.clear();
+	glm::mat4 room = roomModel(angle);
+	for (size_t i = 0; i < catalog.size(); i++)
+	{
+		glm::mat4 model = tableModel(room, catalog.position[i], catalog.angle[i]);
+		if (!boxInFrustum(viewProjection * model, catalog.boundsMin[i], catalog.boundsMax[i]))
+			continue;
+		visible.push_back(i);
+		models.push_back(model);
+	}
+}
+
+bool boxInFrustum(const glm::mat4& mvp, glm::vec3 boundsMin, glm::vec3 boundsMax)
+{
+	//the planes of the clip space cube, taken from the rows of mvp, are in the space of the box
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (int side = -1; side <= 1; side += 2)
+		{
+			glm::vec4 plane;
+			for (int k = 0; k < 4; k++)
+			{
+				plane[k] = mvp[k][3] + side * mvp[k][axis];
+			}
+			//the corner farthest along the plane normal decides
+			glm::vec3 corner(plane.x > 0 ? boundsMax.x : boundsMin.x, plane.y > 0 ? boundsMax.y : boundsMin.y, plane.z > 0 ? boundsMax.z : boundsMin.z);
+			if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+				return false;
+		}
+	}
+	return true;
+}
+
+float tableError(const Camera& camera, const TableCatalog& catalog, size_t index, const glm::mat4& model)
+{
+	//round parts are tessellated for the closest point of the table
+	glm::vec3 center = (catalog.boundsMin[index] + catalog.boundsMax[index]) * 0.5f;
+	float radius = glm::length(catalog.boundsMax[index] - catalog.boundsMin[index]) * 0.5f;
+	glm::vec4 viewCenter = camera.view * model * glm::vec4(center, 1.0f);
+	return tessellationError(camera, glm::length(glm::vec3(viewCenter)) - radius);
+}
+
+void Scene::draw(const Camera& camera, int modelLoc, float angle, MeshLoader* loader, StreamBuffer* stream)
+{
+	glm::mat4 viewProjection = camera.projection * camera.view;
+	cullTables(catalog, viewProjection, angle, OUT visibleTables, OUT visibleModels);
+	visible = visibleTables.size();
+	//tables that share meshes are drawn with the finest tessellation any of them needs, so they don't
+	//rebuild the meshes for each other
+	visibleErrors.resize(visibleTables.size());
+	for (size_t i = 0; i < visibleTables.size(); i++)
+	{
+		unsigned int index = visibleTables[i];
+		if (meshes[index] == nullptr)
+			meshes[index] = findMeshes(index);
+		meshes[index]->maxError = std::numeric_limits<float>::max();
+		visibleErrors[i] = tableError(camera, catalog, index, visibleModels[i]);
+	}
+	for (size_t i = 0; i < visibleTables.size(); i++)
+	{
+		SharedMeshes& table = *meshes[visibleTables[i]];
+		table.maxError = std::min(table.maxError, visibleErrors[i]);
+	}
+	for (size_t i = 0; i < visibleTables.size(); i++)
+	{
+		unsigned int index = visibleTables[i];
+		const glm::mat4& model = visibleModels[i];
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &model[0][0]);
+
+		drawTable(tableSpec(catalog, index), meshes[index]->meshes, meshes[index]->maxError, loader, stream);
+	}
+}
+
+void drawScene(Camera& camera, int modelLoc, Scene& scene, float angle, MeshLoader* loader, FrameTimer* timer, StreamBuffer* stream)
+{
+	if (timer != nullptr)
+		timer->beginPhase(PHASE_SETUP);
+	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	updateCamera(camera); //uploads only after a resize
+
+	if (timer != nullptr)
+		timer->beginPhase(PHASE_DRAW);
+	scene.draw(camera, modelLoc, angle, loader, stream);
+}
+
+bool resizeInput(GLFWwindow* window, Scene& scene, float seconds)
+{
+	if (scene.size() == 0)
+		return false;
+	float step = RESIZE_SPEED * seconds, width = 0.0f, length = 0.0f;
+	if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+		width += step;
+	if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+		width -= step;
+	if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+		length += step;
+	if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+		length -= step;
+	if (width == 0.0f && length == 0.0f)
+		return false;
+	TableSpec table = tableSpec(scene.getCatalog(), 0);
+	scene.resize(0, table.plotWidth + width, table.plotLength + length);
+	return true;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "functionality.h"
+
+#include <map>
+#include <tuple>
+
+const float RESIZE_SPEED = 50.0f; //cm per second while an arrow key is held
+const float MIN_PLOT_SIZE = 30.0f;
+const float MAX_PLOT_SIZE = 400.0f;
+
+//sizes of the plots or the legs of one kind, a column per size
+struct ShapeColumns
+{
+	std::vector<float> width;
+	std::vector<float> length;
+	std::vector<float> height;
+	std::vector<unsigned int> table; //the table the shape belongs to
+};
+
+//Tables in columns, one entry per table in each, with their plots and legs grouped by kind.
+//Passes over many tables read only the columns they need from contiguous memory: culling reads the
+//positions, angles and bounds, building runs one loop per kind of shape over that kind's columns.
+struct TableCatalog
+{
+	std::vector<Point> position; //on the floor, in the same z up coordinates as the shapes
+	std::vector<float> angle; //around the vertical axis, in radians
+	std::vector<glm::vec3> boundsMin; //box around the table, relative to position
+	std::vector<glm::vec3> boundsMax;
+	std::vector<unsigned char> plotKind; //KIND of the plot, its sizes are in plots[plotKind]
+	std::vector<unsigned int> plotSlot; //where in those columns
+	std::vector<unsigned char> legKind;
+	std::vector<unsigned int> legSlot;
+	ShapeColumns plots[PLOT_KINDS];
+	ShapeColumns legs[LEG_KINDS];
+
+	size_t size() const { return position.size(); }
+};
+
+size_t addTable(TableCatalog& catalog, const TableSpec& spec, Point position, float angle); //the bounds stay empty until updateBounds
+TableSpec tableSpec(const TableCatalog& catalog, size_t index);
+void resizeTable(TableCatalog& catalog, size_t index, float width, float length); //of the plot, with its bounds
+void updateBounds(TableCatalog& catalog); //of all tables
+//indices and model matrices of the tables whose bounds intersect the view frustum, angle turns the whole room
+void cullTables(const TableCatalog& catalog, const glm::mat4& viewProjection, float angle, OUT std::vector<unsigned int>& visible, OUT std::vector<glm::mat4>& models);
+
+typedef std::tuple<int, float, float, float, int, float, float, float> SpecKey; //every number of a TableSpec
+SpecKey specKey(const TableSpec& table);
+
+//the meshes of all tables with one spec, built for the closest of them
+struct SharedMeshes
+{
+	TableMeshes meshes;
+	int users; //tables drawn with them
+	bool keyed; //in Scene::shared, a resized table gets meshes of its own
+	float maxError; //finest any visible user needs in this frame
+
+	explicit SharedMeshes(const TableSpec& table) : meshes(table) { users = 1; keyed = true; maxError = 0.0f; }
+};
+
+//Tables placed around the room. Only those whose bounding box intersects the view frustum are drawn.
+class Scene
+{
+public:
+	Scene() { visible = 0; }
+	~Scene();
+	Scene(const Scene&) = delete;
+	Scene& operator = (const Scene&) = delete;
+
+	void add(const TableSpec& table, Point position = Point(0, 0, 0), float angle = 0.0f);
+	bool load(const std::string& path);
+	size_t size() const { return catalog.size(); }
+	int visibleCount() const { return visible; } //drawn in the last frame
+	const TableCatalog& getCatalog() const { return catalog; }
+	void resize(size_t index, float width, float length); //of the plot, the legs follow
+
+	//draws with the program that is in use, angle turns the whole room
+	void draw(const Camera& camera, int modelLoc, float angle, MeshLoader* loader = nullptr, StreamBuffer* stream = nullptr);
+
+private:
+	TableCatalog catalog;
+	std::vector<SharedMeshes*> meshes; //found or made when a table is first drawn, most of a large room never is
+	std::map<SpecKey, SharedMeshes*> shared;
+	std::vector<unsigned int> visibleTables; //of the last frame, kept for their memory
+	std::vector<glm::mat4> visibleModels;
+	std::vector<float> visibleErrors;
+	int visible;
+
+	SharedMeshes* findMeshes(size_t index);
+};
+
+void tableBounds(const TableSpec& table, OUT glm::vec3& boundsMin, OUT glm::vec3& boundsMax);
+glm::mat4 roomModel(float sceneAngle); //z up table coordinates to the y up world, turned by sceneAngle
+glm::mat4 tableModel(const glm::mat4& room, Point position, float tableAngle);
+float tableError(const Camera& camera, const TableCatalog& catalog, size_t index, const glm::mat4& model);
+bool boxInFrustum(const glm::mat4& mvp, glm::vec3 boundsMin, glm::vec3 boundsMax);
+void drawScene(Camera& camera, int modelLoc, Scene& scene, float angle, MeshLoader* loader = nullptr, FrameTimer* timer = nullptr, StreamBuffer* stream = nullptr);
+bool resizeInput(GLFWwindow* window, Scene& scene, float seconds); //arrow keys resize the first table, true when they did
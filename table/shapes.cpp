@@ -0,0 +1,48 @@
+#include "shapes.h"
+
+
+int plotKind(Shape shape)
+{
+	return shape == OvalPlot::SHAPE ? OvalPlot::KIND : RectPlot::KIND;
+}
+
+int legKind(Shape shape)
+{
+	return shape == CircleLeg::SHAPE ? CircleLeg::KIND : RectLeg::KIND;
+}
+
+void fitTable(TableSpec& spec)
+{
+	if (spec.plotShape == OvalPlot::SHAPE)
+		spec.plotWidth = OvalPlot::fitWidth(spec.plotWidth, spec.plotLength);
+	else
+		spec.plotWidth = RectPlot::fitWidth(spec.plotWidth, spec.plotLength);
+}
+
+void buildPlot(const TableSpec& spec, OUT MeshData& data, float maxError)
+{
+	if (spec.plotShape == OvalPlot::SHAPE)
+		OvalPlot::build(OUT data, spec.plotWidth, spec.plotLength, spec.plotHeight, maxError);
+	else
+		RectPlot::build(OUT data, spec.plotWidth, spec.plotLength, spec.plotHeight, maxError);
+}
+
+void buildLeg(const TableSpec& spec, OUT MeshData& data, float maxError)
+{
+	if (spec.legShape == CircleLeg::SHAPE)
+		CircleLeg::build(OUT data, spec.legWidth, spec.legLength, spec.legHeight, maxError);
+	else
+		RectLeg::build(OUT data, spec.legWidth, spec.legLength, spec.legHeight, maxError);
+}
+
+float legMaxDist(const TableSpec& spec)
+{
+	if (spec.legShape == CircleLeg::SHAPE)
+		return CircleLeg::maxDist(spec.legWidth, spec.legLength);
+	return RectLeg::maxDist(spec.legWidth, spec.legLength);
+}
+
+std::vector<Point> tableLegCenters(const TableSpec& spec)
+{
+	return legCenters(spec.plotShape, spec.plotWidth, spec.plotLength, spec.plotHeight, legMaxDist(spec), spec.legHeight);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "geometry.h"
+
+#ifndef OUT
+#define OUT
+#endif
+
+const float MAX_OVAL_RATIO = 1.3f; //widest oval plot, in lengths
+
+//One table as plain numbers, what the questions and the scene and batch files describe.
+//Plots are built around (0, 0, 0), the legs stand under them at legCenters.
+struct TableSpec
+{
+	Shape plotShape; //RECTANGLE or OVAL
+	float plotWidth;
+	float plotLength;
+	float plotHeight;
+	Shape legShape; //RECTANGLE or CIRCLE, square legs are rectangles
+	float legWidth; //the radius of circle legs
+	float legLength;
+	float legHeight;
+
+	TableSpec() { plotShape = RECTANGLE; legShape = RECTANGLE; plotWidth = plotLength = plotHeight = legWidth = legLength = legHeight = 0.0f; }
+};
+
+//Every kind of plot and leg is a struct of static functions over its sizes. Code that runs over many shapes
+//keeps them grouped by kind and instantiates its loop once per kind, so the calls are inlined instead of virtual.
+//KIND numbers the kind among the plots or among the legs.
+
+struct RectPlot
+{
+	static const int KIND = 0;
+	static const Shape SHAPE = RECTANGLE;
+	static float fitWidth(float width, float length) { return width; }
+	static void build(OUT MeshData& data, float width, float length, float height, float maxError) { buildParallelepiped(OUT data, width, length, height); }
+	static void extent(float width, float length, OUT float& minX, OUT float& maxX) { minX = -width / 2; maxX = width / 2; }
+};
+
+struct OvalPlot
+{
+	static const int KIND = 1;
+	static const Shape SHAPE = OVAL;
+	static float fitWidth(float width, float length) { return std::min(width, MAX_OVAL_RATIO * length); }
+	static void build(OUT MeshData& data, float width, float length, float height, float maxError) { buildOvalPlot(OUT data, width, length, height, Point(0, 0, 0), maxError); }
+	static void extent(float width, float length, OUT float& minX, OUT float& maxX)
+	{
+		//the big circle of the oval is around the center, the small one ends at width - R
+		minX = -length / 2;
+		maxX = width - length / 2;
+	}
+};
+
+struct RectLeg
+{
+	static const int KIND = 0;
+	static const Shape SHAPE = RECTANGLE;
+	static float maxDist(float width, float length) { return std::max(width / 2, length / 2); }
+	static void build(OUT MeshData& data, float width, float length, float height, float maxError) { buildParallelepiped(OUT data, width, length, height); }
+};
+
+struct CircleLeg
+{
+	static const int KIND = 1;
+	static const Shape SHAPE = CIRCLE;
+	static float maxDist(float radius, float length) { return radius; }
+	static void build(OUT MeshData& data, float radius, float length, float height, float maxError) { buildCylinder(OUT data, radius, height, Point(0, 0, 0), maxError); }
+};
+
+const int PLOT_KINDS = 2;
+const int LEG_KINDS = 2;
+const Shape PLOT_SHAPES[PLOT_KINDS] = { RectPlot::SHAPE, OvalPlot::SHAPE }; //by KIND
+const Shape LEG_SHAPES[LEG_KINDS] = { RectLeg::SHAPE, CircleLeg::SHAPE };
+
+int plotKind(Shape shape);
+int legKind(Shape shape);
+
+//the same kernels for a single table, picked by its shapes
+void fitTable(TableSpec& spec); //an oval plot is at most MAX_OVAL_RATIO lengths wide
+void buildPlot(const TableSpec& spec, OUT MeshData& data, float maxError);
+void buildLeg(const TableSpec& spec, OUT MeshData& data, float maxError); //one leg, drawn at every leg center
+float legMaxDist(const TableSpec& spec);
+std::vector<Point> tableLegCenters(const TableSpec& spec);
@@ -0,0 +1,174 @@
+#include "streambuffer.h"
+#include "functionality.h"
+#include "console.h"
+
+#include <cstring>
+
+
+StreamBuffer::StreamBuffer()
+{
+	buffer = VAO = 0;
+	size = head = 0;
+	mapped = nullptr;
+	frame = 0;
+	for (int i = 0; i < STREAM_FRAMES; i++)
+	{
+		fences[i] = nullptr;
+	}
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	if (buffer == 0)
+		return;
+	for (int i = 0; i < STREAM_FRAMES; i++)
+	{
+		if (fences[i] != nullptr)
+			glDeleteSync(fences[i]);
+	}
+	if (mapped != nullptr)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &buffer);
+}
+
+bool StreamBuffer::create(GLADloadproc load, size_t _size)
+{
+	size = _size;
+	int major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	BufferStorage bufferStorage = nullptr;
+	if (major > 4 || (major == 4 && minor >= 4) || hasExtension("GL_ARB_buffer_storage"))
+		bufferStorage = (BufferStorage)load("glBufferStorage");
+
+	glGenBuffers(1, &buffer);
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	if (bufferStorage != nullptr)
+	{
+		//coherent, so nothing has to be flushed before drawing
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		bufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+		mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+		if (mapped == nullptr)
+		{
+			//the storage can't be replaced, mapping every write needs a buffer of its own
+			console() << "Failed to map the stream buffer, mapping every write" << std::endl;
+			glDeleteBuffers(1, &buffer);
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		}
+	}
+	if (mapped == nullptr)
+	{
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		GLint64 allocated = 0;
+		glGetBufferParameteri64v(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &allocated);
+		if ((size_t)allocated != size)
+		{
+			console() << "Failed to allocate the stream buffer" << std::endl;
+			glBindVertexArray(0);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glDeleteVertexArrays(1, &VAO);
+			glDeleteBuffers(1, &buffer);
+			buffer = VAO = 0;
+			return false;
+		}
+	}
+
+	//the vertices, the indices and the instances of every draw are all in this one buffer
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(2, 1);
+	glEnableVertexAttribArray(2);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	frame = 0;
+	head = 0;
+	return true;
+}
+
+void StreamBuffer::beginFrame()
+{
+	frame = (frame + 1) % STREAM_FRAMES;
+	head = frame * (size / STREAM_FRAMES);
+	if (fences[frame] == nullptr)
+		return;
+	//normally long signaled, the GPU is STREAM_FRAMES - 1 frames behind at most
+	while (glClientWaitSync(fences[frame], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+	{
+	}
+	glDeleteSync(fences[frame]);
+	fences[frame] = nullptr;
+}
+
+void StreamBuffer::endFrame()
+{
+	if (head == frame * (size / STREAM_FRAMES))
+		return; //nothing written, nothing to wait for later
+	fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool StreamBuffer::write(const void* data, size_t bytes, size_t alignment, OUT size_t& offset)
+{
+	offset = (head + alignment - 1) / alignment * alignment;
+	if (buffer == 0 || offset + bytes > (frame + 1) * (size / STREAM_FRAMES))
+		return false;
+	if (mapped != nullptr)
+		memcpy(mapped + offset, data, bytes);
+	else
+	{
+		//the fences already keep the GPU out of this range, so the driver doesn't have to
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		void* range = glMapBufferRange(GL_ARRAY_BUFFER, offset, bytes, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+		if (range == nullptr)
+			return false;
+		memcpy(range, data, bytes);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	head = offset + bytes;
+	return true;
+}
+
+bool StreamBuffer::draw(const MeshData& data, const std::vector<Point>& offsets)
+{
+	size_t vertexOffset, indexOffset, instanceOffset, offset;
+	const size_t vertexSize = 3 * sizeof(float);
+	if (data.indices.empty() || offsets.empty() ||
+		!write(data.vertices.data(), data.vertices.size() * sizeof(float), vertexSize, OUT vertexOffset) ||
+		!write(data.indices.data(), data.indices.size() * sizeof(unsigned int), sizeof(unsigned int), OUT indexOffset))
+		return false;
+	//streamed vertices are always floats, so every instance has a dequantize scale of 1
+	const Point one(1.0f, 1.0f, 1.0f);
+	for (size_t i = 0; i < offsets.size(); i++)
+	{
+		if (!write(&offsets[i], sizeof(Point), sizeof(float), OUT offset) || !write(&one, sizeof(Point), sizeof(float), OUT offset))
+			return false;
+		if (i == 0)
+			instanceOffset = offset - sizeof(Point);
+	}
+
+	glBindVertexArray(VAO);
+	//only the instance pointers move, the vertices are found through the base vertex
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Point), (void*)instanceOffset);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Point), (void*)(instanceOffset + sizeof(Point)));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, data.indices.size(), GL_UNSIGNED_INT, (void*)indexOffset, offsets.size(), vertexOffset / vertexSize);
+	glStatsCount(STAT_CALLS);
+	glStatsCount(STAT_DRAW_CALLS);
+	glStatsCount(STAT_TRIANGLES, (long long)data.indices.size() / 3 * offsets.size());
+	glBindVertexArray(0);
+	return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "glstats.h"
+#include "geometry.h"
+
+//GL 4.4 names that the 3.3 glad loader does not know
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+const size_t STREAM_BUFFER_SIZE = 4 << 20; //bytes, split between the frames in flight
+const int STREAM_FRAMES = 3; //frames the GPU may still be reading while the next one is written
+const int RESIZE_SETTLE_FRAMES = 10; //frames without a change before a streamed shape gets its cached mesh again
+
+//Ring buffer for geometry that changes every frame. Every frame writes its own part of one buffer that is
+//mapped once for its whole life, a fence guards the part until the GPU is done drawing from it, so writing
+//neither allocates nor waits for the driver. Without buffer storage (GL 4.4) every write maps its range
+//unsynchronized, the fences keep that safe too.
+class StreamBuffer
+{
+public:
+	StreamBuffer();
+	~StreamBuffer();
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator = (const StreamBuffer&) = delete;
+
+	bool create(GLADloadproc load, size_t size = STREAM_BUFFER_SIZE); //false when no buffer could be made, nothing can be streamed then
+	void beginFrame(); //waits until the GPU is done with the part this frame writes
+	void endFrame(); //fences everything written in this frame
+	//copies size bytes to an offset that is a multiple of alignment, false when the frame is out of space
+	bool write(const void* data, size_t size, size_t alignment, OUT size_t& offset);
+	//draws the mesh once for every offset, straight from the ring with a base vertex
+	bool draw(const MeshData& data, const std::vector<Point>& offsets);
+	bool isPersistent() const { return mapped != nullptr; }
+
+private:
+	typedef void (APIENTRYP BufferStorage)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+	unsigned int buffer, VAO;
+	size_t size;
+	unsigned char* mapped; //the whole buffer, null when every write maps its own range
+	int frame; //part of the buffer written now
+	size_t head; //next free byte of that part
+	GLsync fences[STREAM_FRAMES];
+};
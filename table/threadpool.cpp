@@ -0,0 +1,106 @@
+#include "threadpool.h"
+
+
+ThreadPool::ThreadPool(int threadCount, Task start, Task stop)
+	: queued(0), pending(0), nextQueue(0), stopping(false)
+{
+	if (threadCount < 1)
+		threadCount = 1;
+	for (int i = 0; i < threadCount; i++)
+	{
+		queues.push_back(std::unique_ptr<Queue>(new Queue()));
+	}
+	for (int i = 0; i < threadCount; i++)
+	{
+		threads.push_back(std::thread(&ThreadPool::run, this, i, start, stop));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+}
+
+void ThreadPool::submit(Task task)
+{
+	pending++;
+	Queue& queue = *queues[nextQueue++ % queues.size()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(task);
+	}
+	{
+		//counted under the sleep mutex, so a worker can't miss the wake up
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		queued++;
+	}
+	wake.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(sleepMutex);
+	done.wait(lock, [this] { return pending == 0; });
+}
+
+bool ThreadPool::pop(int worker, OUT Task& task)
+{
+	for (size_t i = 0; i < queues.size(); i++)
+	{
+		Queue& queue = *queues[(worker + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+			continue;
+		if (i == 0) //own queue
+		{
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+		}
+		queued--;
+		return true;
+	}
+	return false;
+}
+
+void ThreadPool::run(int worker, Task start, Task stop)
+{
+	if (start)
+		start(worker);
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			wake.wait(lock, [this] { return queued > 0 || stopping; });
+			if (stopping && queued == 0)
+				break;
+		}
+
+		Task task;
+		if (!pop(worker, OUT task))
+			continue; //another worker was faster
+		task(worker);
+
+		if (--pending == 0)
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			done.notify_all();
+		}
+	}
+
+	if (stop)
+		stop(worker);
+}
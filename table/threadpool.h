@@ -0,0 +1,52 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+
+#ifndef OUT
+#define OUT  //mark out parameters
+#endif
+
+//Fixed set of worker threads, each with its own task queue. Tasks are handed out round-robin,
+//a worker runs its own tasks newest first and steals the oldest ones from the others when it runs dry.
+class ThreadPool
+{
+public:
+	typedef std::function<void(int worker)> Task;
+
+	//start and stop run on every worker thread before its first and after its last task
+	ThreadPool(int threadCount, Task start = Task(), Task stop = Task());
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator = (const ThreadPool&) = delete;
+
+	void submit(Task task);
+	void wait(); //blocks until every submitted task has finished
+	int size() const { return (int)threads.size(); }
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> threads;
+	std::atomic<int> queued; //tasks waiting in the queues
+	std::atomic<int> pending; //tasks submitted but not finished
+	std::atomic<unsigned int> nextQueue;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	bool stopping;
+
+	void run(int worker, Task start, Task stop);
+	bool pop(int worker, OUT Task& task);
+};